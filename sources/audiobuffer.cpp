@@ -23,10 +23,24 @@
 #include "audiobuffer.h"
 #include <algorithm>
 #include <string.h>
-
-AudioBuffer::AudioBuffer( int aAmountOfChannels, int aBufferSize )
+#if defined(_WIN32)
+#   define NOMINMAX
+#   include <windows.h>
+#else
+#   include <sys/mman.h>
+#endif
+
+#if !defined(_WIN32) && !defined(MAP_ANONYMOUS)
+#   define MAP_ANONYMOUS MAP_ANON
+#endif
+#if !defined(_WIN32) && !defined(MAP_NORESERVE)
+#   define MAP_NORESERVE 0
+#endif
+
+AudioBuffer::AudioBuffer( int aAmountOfChannels, int aBufferSize, bool aLazilyCommitted )
 {
     loopeable        = false;
+    lazilyCommitted  = aLazilyCommitted;
     amountOfChannels = aAmountOfChannels;
     bufferSize       = aBufferSize;
 
@@ -34,18 +48,25 @@ AudioBuffer::AudioBuffer( int aAmountOfChannels, int aBufferSize )
 
     _buffers = new std::vector<float*>( amountOfChannels );
 
-    // fill buffers with silence
-
     for ( int i = 0; i < amountOfChannels; ++i ) {
-        _buffers->at( i ) = new float[ aBufferSize ];
-        memset( _buffers->at( i ), 0, aBufferSize * sizeof( float )); // zero bits should equal 0.f
+        _buffers->at( i ) = allocateChannel();
+
+        // could not reserve the memory, fall back to regular allocation for all channels
+
+        if ( _buffers->at( i ) == 0 ) {
+            for ( int j = 0; j < i; ++j )
+                freeChannel( _buffers->at( j ));
+
+            lazilyCommitted = false;
+            i = -1;
+        }
     }
 }
 
 AudioBuffer::~AudioBuffer()
 {
     while ( !_buffers->empty()) {
-        delete[] _buffers->back(), _buffers->pop_back();
+        freeChannel( _buffers->back()), _buffers->pop_back();
     }
     delete _buffers;
 }
@@ -106,9 +127,14 @@ int AudioBuffer::mergeBuffers( AudioBuffer* aBuffer, int aReadOffset, int aWrite
  */
 void AudioBuffer::silenceBuffers()
 {
+    // lazily committed buffers have their memory replaced with fresh pages, which
+    // releases the pages that were in use rather than zero filling all of them
+
     // use mem set to quickly erase existing buffer contents, zero bits should equal 0.f
-    for ( int i = 0; i < amountOfChannels; ++i )
-        memset( getBufferForChannel( i ), 0, bufferSize * sizeof( float ));
+    for ( int i = 0; i < amountOfChannels; ++i ) {
+        if ( !lazilyCommitted || !recommitChannel( getBufferForChannel( i )))
+            memset( getBufferForChannel( i ), 0, bufferSize * sizeof( float ));
+    }
 }
 
 void AudioBuffer::adjustBufferVolumes( float amp )
@@ -149,3 +175,50 @@ AudioBuffer* AudioBuffer::clone()
     }
     return output;
 }
+
+/* protected methods */
+
+float* AudioBuffer::allocateChannel()
+{
+    size_t size = bufferSize * sizeof( float );
+
+    if ( lazilyCommitted ) {
+#if defined(_WIN32)
+        void* memory = VirtualAlloc( 0, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+        return ( float* ) memory;
+#else
+        void* memory = mmap( 0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+        return ( memory != MAP_FAILED ) ? ( float* ) memory : 0;
+#endif
+    }
+
+    float* buffer = new float[ bufferSize ];
+    memset( buffer, 0, size ); // zero bits should equal 0.f
+    return buffer;
+}
+
+void AudioBuffer::freeChannel( float* buffer )
+{
+    if ( !lazilyCommitted ) {
+        delete[] buffer;
+        return;
+    }
+#if defined(_WIN32)
+    VirtualFree( buffer, 0, MEM_RELEASE );
+#else
+    munmap( buffer, bufferSize * sizeof( float ));
+#endif
+}
+
+bool AudioBuffer::recommitChannel( float* buffer )
+{
+    size_t size = bufferSize * sizeof( float );
+#if defined(_WIN32)
+    return VirtualFree( buffer, size, MEM_DECOMMIT ) &&
+           VirtualAlloc( buffer, size, MEM_COMMIT, PAGE_READWRITE ) != 0;
+#else
+    // mapping over the existing range atomically replaces its pages
+    void* memory = mmap( buffer, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0 );
+    return memory != MAP_FAILED;
+#endif
+}
@@ -30,16 +30,21 @@
  * An AudioBuffer represents multiple channels of audio
  * each of equal buffer length.
  * AudioBuffer has convenience methods for cloning, silencing and mixing
+ *
+ * the memory of a lazily committed AudioBuffer is reserved from the operating
+ * system without being touched, pages are zero filled by the system when they are
+ * first accessed. This suits large buffers of which only a portion might be used
  */
 class AudioBuffer
 {
     public:
-        AudioBuffer( int aAmountOfChannels, int aBufferSize );
+        AudioBuffer( int aAmountOfChannels, int aBufferSize, bool aLazilyCommitted = false );
         ~AudioBuffer();
 
         int amountOfChannels;
         int bufferSize;
         bool loopeable;
+        bool lazilyCommitted;
 
         float* getBufferForChannel( int aChannelNum );
         int mergeBuffers( AudioBuffer* aBuffer, int aReadOffset, int aWriteOffset, float aMixVolume );
@@ -50,6 +55,10 @@ class AudioBuffer
 
     protected:
         std::vector<float*>* _buffers;
+
+        float* allocateChannel();
+        void freeChannel( float* buffer );
+        bool recommitChannel( float* buffer );
 };
 
 #endif
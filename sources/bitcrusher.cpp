@@ -83,6 +83,26 @@ void BitCrusher::setLFO( float LFORatePercentage, float LFODepth )
 }
 
 void BitCrusher::process( float* inBuffer, int bufferSize )
+{
+    if ( !hasLFO ) {
+        process( inBuffer, bufferSize, 0 );
+        return;
+    }
+
+    float modulation[ VST::LFO_BLOCK_SIZE ];
+
+    for ( int i = 0; i < bufferSize; i += VST::LFO_BLOCK_SIZE )
+    {
+        int blockSize = std::min( VST::LFO_BLOCK_SIZE, bufferSize - i );
+
+        for ( int j = 0; j < blockSize; ++j )
+            modulation[ j ] = lfo->peek();
+
+        process( inBuffer + i, blockSize, modulation );
+    }
+}
+
+void BitCrusher::process( float* inBuffer, int bufferSize, const float* modulation )
 {
     // sound should not be crushed ? do nothing
     if ( _bits == 16 && !hasLFO )
@@ -94,22 +114,28 @@ void BitCrusher::process( float* inBuffer, int bufferSize )
     {
         short input = ( short ) (( inBuffer[ i ] * _inputMix ) * SHRT_MAX );
         short prevent_offset = ( short )( -1 >> bitsPlusOne );
-        input &= ( -1 << ( 16 - _bits ));
+        input &= ( short )( ~0u << ( 16 - _bits ));
         inBuffer[ i ] = (( input + prevent_offset ) * _outputMix ) / SHRT_MAX;
 
-        if ( hasLFO ) {
-            // multiply by .5 and add .5 to make the LFO's bipolar waveform unipolar
-            float lfoValue = lfo->peek() * .5f  + .5f;
-            _tempAmount = std::min( _lfoMax, _lfoMin + _lfoRange * lfoValue );
+        // the resolution only needs recalculating when the oscillator value changes
 
-            // recalculate the current resolution
-            calcBits();
+        if ( hasLFO && ( i == 0 || modulation[ i ] != modulation[ i - 1 ] )) {
+            applyLFO( modulation[ i ] );
             bitsPlusOne = _bits + 1;
         }
     }
 }
 
-/* setters */
+/* getters / setters */
+
+int BitCrusher::getMaxBits()
+{
+    if ( !hasLFO )
+        return _bits;
+
+    // the oscillator moves the resolution up to the top of its range
+    return ( int ) floor( Calc::scale( _lfoMax, 1, 15 )) + 1;
+}
 
 void BitCrusher::setAmount( float value )
 {
@@ -135,6 +161,32 @@ void BitCrusher::setOutputMix( float value )
     _outputMix = Calc::cap( value );
 }
 
+void BitCrusher::reset()
+{
+    lfo->setAccumulator( 0.f );
+    _tempAmount = _amount;
+    calcBits();
+}
+
+void BitCrusher::advance( int bufferSize )
+{
+    if ( !hasLFO || bufferSize <= 0 )
+        return;
+
+    // the resolution follows the oscillator value read for the last sample
+
+    lfo->advance( bufferSize - 1 );
+    applyLFO( lfo->peek() );
+}
+
+void BitCrusher::advance( int bufferSize, const float* modulation )
+{
+    if ( !hasLFO || bufferSize <= 0 )
+        return;
+
+    applyLFO( modulation[ bufferSize - 1 ] );
+}
+
 /* private methods */
 
 void BitCrusher::cacheLFO()
@@ -150,4 +202,13 @@ void BitCrusher::calcBits()
     _bits = ( int ) floor( Calc::scale( _tempAmount, 1, 15 )) + 1;
 }
 
+void BitCrusher::applyLFO( float lfoValue )
+{
+    // multiply by .5 and add .5 to make the LFO's bipolar waveform unipolar
+    _tempAmount = std::min( _lfoMax, _lfoMin + _lfoRange * ( lfoValue * .5f  + .5f ));
+
+    // recalculate the current resolution
+    calcBits();
+}
+
 }
@@ -35,10 +35,32 @@ class BitCrusher {
         void setLFO( float LFORatePercentage, float LFODepth );
         void process( float* inBuffer, int bufferSize );
 
+        // as above, with the resolution following given oscillator values (one per
+        // sample, e.g. as rendered by the ModulationBus) instead of the own oscillator
+        // moving along. The values are only read when the LFO is enabled
+
+        void process( float* inBuffer, int bufferSize, const float* modulation );
+
         void setAmount( float value ); // range between -1 to +1
+
+        // the highest resolution (in bits) the output can currently have
+        // this is 16 when the crusher is bypassed
+        int getMaxBits();
         void setInputMix( float value );
         void setOutputMix( float value );
 
+        // rewinds the oscillator to the start of its cycle
+
+        void reset();
+
+        // moves the oscillator along by given amount of samples without processing
+
+        void advance( int bufferSize );
+
+        // as above, for given oscillator values instead of the own oscillator
+
+        void advance( int bufferSize, const float* modulation );
+
         LFO* lfo;
         bool hasLFO;
 
@@ -50,6 +72,7 @@ class BitCrusher {
 
         void cacheLFO();
         void calcBits();
+        void applyLFO( float lfoValue );
         float _tempAmount;
         float _lfoDepth;
         float _lfoRange;
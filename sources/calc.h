@@ -95,6 +95,158 @@ namespace Calc {
     {
         return value > .5;
     }
+
+    /**
+     * approximations of the functions used to calculate the coefficients of the effects
+     *
+     * these do not depend on the C library, so they give the same results on every
+     * platform, and are free of branches (the selects compile to blends), so the loops
+     * of the array versions vectorize. The error bounds stated are the largest errors
+     * measured against double precision over the given domain, "regrader-verify accuracy"
+     * checks them. They are meant for coefficients calculated per sample, coefficients that
+     * are only calculated when a parameter changes keep using the C library, so the output
+     * of existing settings does not change
+     */
+    namespace Fast {
+
+        // rounds given value down to an integer value, exactly as std::floor() does
+        // for all values (apart from returning +0 rather than -0 for -0)
+
+        inline float floor( float value )
+        {
+            float clamped   = std::min( 8388608.f, std::max( -8388608.f, value ));
+            float truncated = ( float )( int32 ) clamped;
+
+            truncated -= ( truncated > value ) ? 1.f : 0.f;
+
+            // from 2^23 onwards every float value is an integer value
+
+            return ( std::abs( value ) < 8388608.f ) ? truncated : value;
+        }
+
+        // e^r for r within +/- ln( 2 ) / 2 (Taylor series to the 7th power)
+
+        inline float expReduced( float r )
+        {
+            return 1.f + r * ( 1.f + r * ( 1.f / 2.f + r * ( 1.f / 6.f + r * ( 1.f / 24.f +
+                   r * ( 1.f / 120.f + r * ( 1.f / 720.f + r * ( 1.f / 5040.f )))))));
+        }
+
+        // 2^n for integer values of n in the -126 to 127 range
+
+        inline float powerOfTwo( float n )
+        {
+            int32 bits = (( int32 ) n + 127 ) << 23;
+            float value;
+            memcpy( &value, &bits, sizeof( float ));
+            return value;
+        }
+
+        // e^x, relative error below 2e-7 for x in the -87.3 to 88.3 range. Below this
+        // range the result is 0 (as the C library underflows), above it is clamped
+
+        inline float exp( float x )
+        {
+            float clamped = std::min( 88.3f, std::max( -87.3f, x ));
+
+            // x = n * ln( 2 ) + r, where ln( 2 ) is split in two so n * 0.693359375 is exact
+
+            float n = floor( clamped * 1.44269504088896341f + .5f );
+            float r = clamped - n * .693359375f + n * 2.12194440e-4f;
+
+            return ( x < -87.3f ) ? 0.f : expReduced( r ) * powerOfTwo( n );
+        }
+
+        // 10^x, relative error below 2e-7 for x in the -37.9 to 38.3 range. Below this
+        // range the result is 0 (as the C library underflows), above it is clamped
+
+        inline float pow10( float x )
+        {
+            float clamped = std::min( 38.3f, std::max( -37.9f, x ));
+
+            // x = n * log10( 2 ) + r, where log10( 2 ) is split in two so n * 0.30078125 is exact
+
+            float n = floor( clamped * 3.32192809488736235f + .5f );
+            float r = clamped - n * .30078125f - n * 2.48745663981195213e-4f;
+
+            return ( x < -37.9f ) ? 0.f : expReduced( r * 2.30258509299404568f ) * powerOfTwo( n );
+        }
+
+        // tan( PI * ratio ), for ratio in the 0 - .5 range (exclusive), relative error below
+        // 5e-7. This is the bilinear transform prewarp, where ratio is frequency / sampleRate
+
+        inline float tanPi( float ratio )
+        {
+            // above PI / 4 tan( x ) is calculated as 1 / tan( PI / 2 - x ), where .5 - ratio is
+            // exact so the tangent stays accurate up to the nyquist frequency
+
+            bool reflect = ratio > .25f;
+            float x  = VST::PI * ( reflect ? .5f - ratio : ratio );
+            float x2 = x * x;
+
+            // Pade approximant of order [7/6]
+
+            float numerator   = x * ( 135135.f - x2 * ( 17325.f - x2 * ( 378.f - x2 )));
+            float denominator = 135135.f - x2 * ( 62370.f - x2 * ( 3150.f - x2 * 28.f ));
+
+            return reflect ? denominator / numerator : numerator / denominator;
+        }
+
+        // sin( x ) and cos( x ), absolute error below 1.5e-7 for x in the -8 PI to 8 PI range
+
+        inline void sinCos( float x, float& sine, float& cosine )
+        {
+            // x = quadrant * PI / 2 + r, where PI / 2 is split in three so r is accurate
+
+            float quadrant = floor( x * .636619772367581343f + .5f );
+            float r  = x - quadrant * 1.5703125f - quadrant * 4.837512969970703125e-4f - quadrant * 7.54978995489188216e-8f;
+            float r2 = r * r;
+
+            float s = r + r * r2 * ( -1.6666654611e-1f + r2 * ( 8.3321608736e-3f + r2 * -1.9515295891e-4f ));
+            float c = 1.f - .5f * r2 + r2 * r2 * ( 4.166664568298827e-2f + r2 * ( -1.388731625493765e-3f + r2 * 2.443315711809948e-5f ));
+
+            int32 q = ( int32 ) quadrant & 3;
+
+            float swappedSine   = ( q & 1 ) ? c : s;
+            float swappedCosine = ( q & 1 ) ? s : c;
+
+            sine   = ( q & 2 ) ? -swappedSine : swappedSine;
+            cosine = (( q + 1 ) & 2 ) ? -swappedCosine : swappedCosine;
+        }
+
+        // array versions of the above, writing the results for amount arguments to out
+        // (which can be the same as in)
+
+        inline void floor( const float* in, float* out, int amount )
+        {
+            for ( int i = 0; i < amount; ++i )
+                out[ i ] = floor( in[ i ]);
+        }
+
+        inline void exp( const float* in, float* out, int amount )
+        {
+            for ( int i = 0; i < amount; ++i )
+                out[ i ] = exp( in[ i ]);
+        }
+
+        inline void pow10( const float* in, float* out, int amount )
+        {
+            for ( int i = 0; i < amount; ++i )
+                out[ i ] = pow10( in[ i ]);
+        }
+
+        inline void tanPi( const float* in, float* out, int amount )
+        {
+            for ( int i = 0; i < amount; ++i )
+                out[ i ] = tanPi( in[ i ]);
+        }
+
+        inline void sinCos( const float* in, float* sines, float* cosines, int amount )
+        {
+            for ( int i = 0; i < amount; ++i )
+                sinCos( in[ i ], sines[ i ], cosines[ i ]);
+        }
+    }
 }
 }
 
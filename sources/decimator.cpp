@@ -75,6 +75,22 @@ void Decimator::restore()
     _accumulator = _accumulatorStored;
 }
 
+void Decimator::reset()
+{
+    _accumulator = 0.f;
+}
+
+void Decimator::advance( int bufferSize )
+{
+    for ( int i = 0; i < bufferSize; ++i )
+    {
+        _accumulator += _rate;
+
+        if ( _accumulator >= 1.f )
+            _accumulator -= 1.f;
+    }
+}
+
 /* public methods */
 
 void Decimator::process( float* sampleBuffer, int bufferSize )
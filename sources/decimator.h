@@ -52,6 +52,14 @@ class Decimator {
         void store();
         void restore();
 
+        // rewinds the internal oscillator
+
+        void reset();
+
+        // moves the internal oscillator along by given amount of samples without processing
+
+        void advance( int bufferSize );
+
     private:
         int _bits;
         long _m;
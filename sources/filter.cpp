@@ -43,26 +43,35 @@ Filter::Filter( float sampleRate ) {
     _b1 = 0.f;
     _b2 = 0.f;
     _c  = 0.f;
+    _g1 = 0.f;
+    _g2 = 0.f;
+    _g3 = 0.f;
+    _m0 = 0.f;
+    _m1 = 0.f;
+    _m2 = 1.f;
 
     lfo = new Igorski::LFO( sampleRate );
 
-    _hasLFO = false;
+    _prewarpTable = TableRegistry::acquire( TableRegistry::kFilterPrewarp, sampleRate );
+
+    _hasLFO   = false;
+    _type     = kClassicLowPass;
+    _sections = 1;
 
     // stereo (2) probably enough...
-    int numChannels = 8;
+    _amountOfChannels = 8;
 
-    _in1  = new float[ numChannels ];
-    _in2  = new float[ numChannels ];
-    _out1 = new float[ numChannels ];
-    _out2 = new float[ numChannels ];
+    _in1  = new float[ _amountOfChannels ];
+    _in2  = new float[ _amountOfChannels ];
+    _out1 = new float[ _amountOfChannels ];
+    _out2 = new float[ _amountOfChannels ];
 
-    for ( int i = 0; i < numChannels; ++i )
-    {
-        _in1 [ i ] = 0.f;
-        _in2 [ i ] = 0.f;
-        _out1[ i ] = 0.f;
-        _out2[ i ] = 0.f;
-    }
+    _ic1eq = new float[ _amountOfChannels ];
+    _ic2eq = new float[ _amountOfChannels ];
+
+    _cascadeState = new float[ _amountOfChannels * 3 * CASCADE_LANES ];
+
+    clearHistory();
     setCutoff( VST::FILTER_MAX_FREQ / 2 );
 }
 
@@ -72,6 +81,9 @@ Filter::~Filter() {
     delete[] _in2;
     delete[] _out1;
     delete[] _out2;
+    delete[] _ic1eq;
+    delete[] _ic2eq;
+    delete[] _cascadeState;
 }
 
 /* public methods */
@@ -105,6 +117,36 @@ void Filter::updateProperties( float cutoffPercentage, float resonancePercentage
 
 void Filter::process( float* sampleBuffer, int bufferSize, int c )
 {
+    if ( !_hasLFO ) {
+        process( sampleBuffer, bufferSize, c, 0 );
+        return;
+    }
+
+    float modulation[ VST::LFO_BLOCK_SIZE ];
+
+    for ( int i = 0; i < bufferSize; i += VST::LFO_BLOCK_SIZE )
+    {
+        int blockSize = std::min( VST::LFO_BLOCK_SIZE, bufferSize - i );
+
+        for ( int j = 0; j < blockSize; ++j )
+            modulation[ j ] = lfo->peek();
+
+        process( sampleBuffer + i, blockSize, c, modulation );
+    }
+}
+
+void Filter::process( float* sampleBuffer, int bufferSize, int c, const float* modulation )
+{
+    if ( _sections > 1 ) {
+        processCascade( sampleBuffer, bufferSize, c, modulation );
+        return;
+    }
+
+    if ( _type != kClassicLowPass ) {
+        processStateVariable( sampleBuffer, bufferSize, c, modulation );
+        return;
+    }
+
     for ( int32 i = 0; i < bufferSize; ++i )
     {
         float input  = sampleBuffer[ i ];
@@ -116,16 +158,11 @@ void Filter::process( float* sampleBuffer, int bufferSize, int c )
         _out1[ c ] = output;
 
         // oscillator attached to Filter ? travel the cutoff values
-        // between the minimum and maximum frequencies
+        // between the minimum and maximum frequencies. The coefficients
+        // only need recalculating when the oscillator value changes
 
-        if ( _hasLFO )
-        {
-            // multiply by .5 and add .5 to make bipolar waveform unipolar
-            float lfoValue = lfo->peek() * .5f  + .5f;
-            _tempCutoff = std::min( _lfoMax, _lfoMin + _lfoRange * lfoValue );
-
-            calculateParameters();
-        }
+        if ( _hasLFO && ( i == 0 || modulation[ i ] != modulation[ i - 1 ] ))
+            applyLFO( modulation[ i ] );
 
         // commit the effect
         sampleBuffer[ i ] = output;
@@ -175,6 +212,47 @@ void Filter::setLFO( bool enabled )
     }
 }
 
+bool Filter::hasLFO()
+{
+    return _hasLFO;
+}
+
+void Filter::setType( int type )
+{
+    type = std::max( 0, std::min( type, kNumTypes - 1 ));
+
+    if ( type == _type )
+        return;
+
+    // the history of one type means nothing to another
+
+    _type = type;
+    clearHistory();
+    calculateParameters();
+}
+
+int Filter::getType()
+{
+    return _type;
+}
+
+void Filter::setSlope( int slope )
+{
+    int sections = 1 << std::max( 0, std::min( slope, kNumSlopes - 1 ));
+
+    if ( sections == _sections )
+        return;
+
+    _sections = sections;
+    clearHistory();
+    calculateParameters();
+}
+
+int Filter::getSlope()
+{
+    return ( _sections == 4 ) ? kSlope48dB : ( _sections == 2 ) ? kSlope24dB : kSlope12dB;
+}
+
 void Filter::store()
 {
     _accumulatorStored = lfo->getAccumulator();
@@ -188,9 +266,90 @@ void Filter::restore()
     calculateParameters();
 }
 
+void Filter::reset()
+{
+    clearHistory();
+    lfo->setAccumulator( 0.f );
+    _tempCutoff = _cutoff;
+    calculateParameters();
+}
+
+void Filter::advance( int bufferSize )
+{
+    if ( !_hasLFO || bufferSize <= 0 )
+        return;
+
+    // the coefficients follow the oscillator value read for the last sample
+
+    lfo->advance( bufferSize - 1 );
+    applyLFO( lfo->peek() );
+}
+
+void Filter::advance( int bufferSize, const float* modulation )
+{
+    if ( !_hasLFO || bufferSize <= 0 )
+        return;
+
+    applyLFO( modulation[ bufferSize - 1 ] );
+}
+
+int Filter::getTailLength( float threshold )
+{
+    // the envelope of the impulse response decays by exp( -PI * cutoff * resonance ) per second
+    // (the resonance being the inverse of Q), the lowest cutoff reached by the LFO rings longest
+
+    float cutoff = _hasLFO ? _lfoMin : _cutoff;
+    int tail     = ( int ) ceil( -log( threshold ) * _sampleRate / ( VST::PI * cutoff * _resonance ));
+
+    // the decays of cascaded sections add up, as do the delays of the pipeline
+
+    if ( _sections > 1 )
+        tail += ( _sections - 1 ) * (( int ) ceil( -log( threshold ) * _sampleRate / ( VST::PI * cutoff * _cascadeDamping[ 0 ] )) + 1 );
+
+    return tail;
+}
+
 void Filter::calculateParameters()
 {
-    _c  = 1.f / tan( VST::PI * _tempCutoff / _sampleRate );
+    if ( _sections > 1 )
+    {
+        if ( _hasLFO )
+            calculateCascade( _prewarpTable->lookup( _tempCutoff ));
+        else
+            calculateCascade( tan( VST::PI * std::min( _tempCutoff, _sampleRate * .49995f ) / _sampleRate ));
+
+        return;
+    }
+
+    if ( _type != kClassicLowPass )
+    {
+        // the resonance is the damping of the state variable filter (the inverse of Q), the
+        // band pass output is scaled by it for unity gain at the cutoff. While the oscillator
+        // moves the cutoff this is the only calculation per sample, the tangent is looked up
+
+        float g;
+
+        if ( _hasLFO )
+            g = _prewarpTable->lookup( _tempCutoff );
+        else
+            g = tan( VST::PI * std::min( _tempCutoff, _sampleRate * .49995f ) / _sampleRate );
+
+        _g1 = 1.f / ( 1.f + g * ( g + _resonance ));
+        _g2 = g * _g1;
+        _g3 = g * _g2;
+
+        _m0 = ( _type == kHighPass ) ? 1.f : 0.f;
+        _m1 = ( _type == kHighPass ) ? -_resonance : ( _type == kBandPass ) ? _resonance : 0.f;
+        _m2 = ( _type == kHighPass ) ? -1.f : ( _type == kLowPass ) ? 1.f : 0.f;
+
+        return;
+    }
+
+    if ( _hasLFO )
+        _c = 1.f / _prewarpTable->lookup( _tempCutoff );
+    else
+        _c = 1.f / tan( VST::PI * _tempCutoff / _sampleRate );
+
     _a1 = 1.f / ( 1.f + _resonance * _c + _c * _c );
     _a2 = 2.f * _a1;
     _a3 = _a1;
@@ -198,6 +357,156 @@ void Filter::calculateParameters()
     _b2 = ( 1.f - _resonance * _c + _c * _c ) * _a1;
 }
 
+/* private methods */
+
+void Filter::applyLFO( float lfoValue )
+{
+    // multiply by .5 and add .5 to make bipolar waveform unipolar
+    _tempCutoff = std::min( _lfoMax, _lfoMin + _lfoRange * ( lfoValue * .5f  + .5f ));
+
+    calculateParameters();
+}
+
+void Filter::processStateVariable( float* sampleBuffer, int bufferSize, int c, const float* modulation )
+{
+    // the trapezoidal integrator states, see "Solving the continuous SVF equations
+    // using trapezoidal integration and equivalent currents" by Andrew Simper
+
+    float ic1eq = _ic1eq[ c ];
+    float ic2eq = _ic2eq[ c ];
+
+    for ( int32 i = 0; i < bufferSize; ++i )
+    {
+        float input = sampleBuffer[ i ];
+        float v3    = input - ic2eq;
+        float v1    = _g1 * ic1eq + _g2 * v3; // band pass
+        float v2    = ic2eq + _g2 * ic1eq + _g3 * v3; // low pass
+
+        ic1eq = 2.f * v1 - ic1eq;
+        ic2eq = 2.f * v2 - ic2eq;
+
+        // see process(), only the cutoff dependent coefficients are updated
+
+        if ( _hasLFO && ( i == 0 || modulation[ i ] != modulation[ i - 1 ] ))
+        {
+            _tempCutoff = std::min( _lfoMax, _lfoMin + _lfoRange * ( modulation[ i ] * .5f  + .5f ));
+
+            float g = _prewarpTable->lookup( _tempCutoff );
+            _g1 = 1.f / ( 1.f + g * ( g + _resonance ));
+            _g2 = g * _g1;
+            _g3 = g * _g2;
+        }
+
+        sampleBuffer[ i ] = _m0 * input + _m1 * v1 + _m2 * v2;
+    }
+    _ic1eq[ c ] = ic1eq;
+    _ic2eq[ c ] = ic2eq;
+}
+
+void Filter::processCascade( float* sampleBuffer, int bufferSize, int c, const float* modulation )
+{
+    // the lanes are held in vectors of the GCC vector extensions (also supported by clang),
+    // the compiler does not vectorize the recursion across the lanes by itself. The members
+    // are plain arrays copied into the vectors, as the Filter is not allocated with the
+    // alignment the vectors require
+
+    typedef float Lanes __attribute__(( vector_size( CASCADE_LANES * sizeof( float ))));
+    static_assert( CASCADE_LANES == 4, "the pipeline below moves the output of four lanes along" );
+
+    float* state = &_cascadeState[ c * 3 * CASCADE_LANES ];
+
+    Lanes ic1eq, ic2eq, input, g1, g2, g3, m0, m1, m2, damping;
+
+    memcpy( &ic1eq,   state,                     sizeof( Lanes ));
+    memcpy( &ic2eq,   state + CASCADE_LANES,     sizeof( Lanes ));
+    memcpy( &input,   state + 2 * CASCADE_LANES, sizeof( Lanes ));
+    memcpy( &g1,      _cascadeG1,                sizeof( Lanes ));
+    memcpy( &g2,      _cascadeG2,                sizeof( Lanes ));
+    memcpy( &g3,      _cascadeG3,                sizeof( Lanes ));
+    memcpy( &m0,      _cascadeM0,                sizeof( Lanes ));
+    memcpy( &m1,      _cascadeM1,                sizeof( Lanes ));
+    memcpy( &m2,      _cascadeM2,                sizeof( Lanes ));
+    memcpy( &damping, _cascadeDamping,           sizeof( Lanes ));
+
+    int last = _sections - 1;
+
+    for ( int32 i = 0; i < bufferSize; ++i )
+    {
+        input[ 0 ] = sampleBuffer[ i ];
+
+        // see processStateVariable()
+
+        Lanes v3 = input - ic2eq;
+        Lanes v1 = g1 * ic1eq + g2 * v3;
+        Lanes v2 = ic2eq + g2 * ic1eq + g3 * v3;
+
+        ic1eq = 2.f * v1 - ic1eq;
+        ic2eq = 2.f * v2 - ic2eq;
+
+        Lanes output = m0 * input + m1 * v1 + m2 * v2;
+
+        // each section passes its output onto the next, which processes it on the next sample
+
+        input = ( Lanes ) { 0.f, output[ 0 ], output[ 1 ], output[ 2 ] };
+
+        if ( _hasLFO && ( i == 0 || modulation[ i ] != modulation[ i - 1 ] ))
+        {
+            _tempCutoff = std::min( _lfoMax, _lfoMin + _lfoRange * ( modulation[ i ] * .5f  + .5f ));
+
+            float g = _prewarpTable->lookup( _tempCutoff );
+
+            g1 = 1.f / ( 1.f + g * ( g + damping ));
+            g2 = g * g1;
+            g3 = g * g2;
+        }
+
+        sampleBuffer[ i ] = output[ last ];
+    }
+
+    memcpy( state,                     &ic1eq, sizeof( Lanes ));
+    memcpy( state + CASCADE_LANES,     &ic2eq, sizeof( Lanes ));
+    memcpy( state + 2 * CASCADE_LANES, &input, sizeof( Lanes ));
+    memcpy( _cascadeG1, &g1, sizeof( Lanes ));
+    memcpy( _cascadeG2, &g2, sizeof( Lanes ));
+    memcpy( _cascadeG3, &g3, sizeof( Lanes ));
+}
+
+void Filter::calculateCascade( float g )
+{
+    // the sections before the last have a Butterworth response (a damping of sqrt( 2 )), lanes
+    // beyond the last section are calculated along but their output is unused
+
+    int type = ( _type == kClassicLowPass ) ? kLowPass : _type;
+
+    for ( int l = 0; l < CASCADE_LANES; ++l )
+    {
+        float damping = ( l == _sections - 1 ) ? _resonance : 1.4142135623730951f;
+
+        _cascadeDamping[ l ] = damping;
+        _cascadeG1[ l ] = 1.f / ( 1.f + g * ( g + damping ));
+        _cascadeG2[ l ] = g * _cascadeG1[ l ];
+        _cascadeG3[ l ] = g * _cascadeG2[ l ];
+        _cascadeM0[ l ] = ( type == kHighPass ) ? 1.f : 0.f;
+        _cascadeM1[ l ] = ( type == kHighPass ) ? -damping : ( type == kBandPass ) ? damping : 0.f;
+        _cascadeM2[ l ] = ( type == kHighPass ) ? -1.f : ( type == kLowPass ) ? 1.f : 0.f;
+    }
+}
+
+void Filter::clearHistory()
+{
+    for ( int i = 0; i < _amountOfChannels; ++i )
+    {
+        _in1  [ i ] = 0.f;
+        _in2  [ i ] = 0.f;
+        _out1 [ i ] = 0.f;
+        _out2 [ i ] = 0.f;
+        _ic1eq[ i ] = 0.f;
+        _ic2eq[ i ] = 0.f;
+    }
+    for ( int i = 0; i < _amountOfChannels * 3 * CASCADE_LANES; ++i )
+        _cascadeState[ i ] = 0.f;
+}
+
 void Filter::cacheLFOProperties()
 {
     _lfoRange = _cutoff * _depth;
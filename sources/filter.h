@@ -25,12 +25,39 @@
 
 #include "global.h"
 #include "lfo.h"
+#include "tableregistry.h"
 #include <math.h>
 
 namespace Igorski {
 class Filter {
 
+    // the amount of state variable filter sections evaluated together for the steeper slopes
+
+    static const int CASCADE_LANES = 4;
+
     public:
+        // the classic type is the biquad low pass of the original plugin, the other
+        // types are zero delay feedback state variable filters, which remain stable
+        // and cheap to update when the oscillator modulates the cutoff every sample
+
+        enum Type {
+            kClassicLowPass = 0,
+            kLowPass,
+            kHighPass,
+            kBandPass,
+            kNumTypes
+        };
+
+        // the steeper slopes cascade two or four state variable filter sections (a classic
+        // type filter then uses the state variable low pass). Only the last section resonates
+
+        enum Slope {
+            kSlope12dB = 0,
+            kSlope24dB,
+            kSlope48dB,
+            kNumSlopes
+        };
+
         Filter( float sampleRate );
         ~Filter();
 
@@ -41,6 +68,17 @@ class Filter {
         void setDepth( float depth );
         float getDepth();
         void setLFO( bool enabled );
+        bool hasLFO();
+
+        // changing the type clears the filter history
+
+        void setType( int type );
+        int getType();
+
+        // changing the slope clears the filter history
+
+        void setSlope( int slope );
+        int getSlope();
 
         void calculateParameters();
 
@@ -50,6 +88,11 @@ class Filter {
         // apply filter to incoming sampleBuffer contents
         void process( float* sampleBuffer, int bufferSize, int c );
 
+        // as above, with the cutoff following given oscillator values (one per sample,
+        // e.g. as rendered by the ModulationBus) instead of the own oscillator moving
+        // along. The values are only read when the LFO is enabled
+        void process( float* sampleBuffer, int bufferSize, int c, const float* modulation );
+
         LFO* lfo;
 
         // store/restore the processor properties
@@ -59,6 +102,22 @@ class Filter {
         void store();
         void restore();
 
+        // clears the filter history and rewinds the oscillator
+
+        void reset();
+
+        // moves the oscillator along by given amount of samples without processing
+
+        void advance( int bufferSize );
+
+        // as above, for given oscillator values instead of the own oscillator
+
+        void advance( int bufferSize, const float* modulation );
+
+        // the amount of samples the impulse response takes to decay below given (linear) threshold
+
+        int getTailLength( float threshold );
+
     private:
         float _cutoff;
         float _tempCutoff;
@@ -68,6 +127,8 @@ class Filter {
         float _lfoMax;
         float _lfoRange;
         bool  _hasLFO;
+        int   _type;
+        int   _sections;
 
         // used internally
 
@@ -86,9 +147,49 @@ class Filter {
         float* _out1;
         float* _out2;
 
+        // state variable filter coefficients, the outputs are mixed from the
+        // input, band pass and low pass signals using the _m coefficients
+
+        float _g1;
+        float _g2;
+        float _g3;
+        float _m0;
+        float _m1;
+        float _m2;
+
+        float* _ic1eq;
+        float* _ic2eq;
+
+        // the cascaded sections run as a pipeline across the lanes, each section processing the
+        // output the previous section produced for the previous sample. This delays the output
+        // by a sample per additional section, but makes the sections independent of each other
+        // so they are calculated together using SIMD instructions
+
+        float _cascadeDamping[ CASCADE_LANES ];
+        float _cascadeG1[ CASCADE_LANES ];
+        float _cascadeG2[ CASCADE_LANES ];
+        float _cascadeG3[ CASCADE_LANES ];
+        float _cascadeM0[ CASCADE_LANES ];
+        float _cascadeM1[ CASCADE_LANES ];
+        float _cascadeM2[ CASCADE_LANES ];
+
+        float* _cascadeState; // ic1eq, ic2eq and the pending input of each lane, per channel
+
+        int _amountOfChannels;
+
         float _sampleRate;
 
+        // shared table of tan() values, used when the LFO modulates
+        // the cutoff as the coefficients are then calculated per sample
+
+        TableRegistry::Table _prewarpTable;
+
         void cacheLFOProperties();
+        void clearHistory();
+        void applyLFO( float lfoValue );
+        void processStateVariable( float* sampleBuffer, int bufferSize, int c, const float* modulation );
+        void processCascade( float* sampleBuffer, int bufferSize, int c, const float* modulation );
+        void calculateCascade( float g );
 };
 }
 
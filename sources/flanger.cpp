@@ -58,6 +58,8 @@ Flanger::Flanger( int amountOfChannels, float sampleRate ) {
     _delayFilter = new LowPassFilter( 20.f, sampleRate );
     _mixFilter   = new LowPassFilter( 20.f, sampleRate );
 
+    sweep = new Sweep();
+
     setRate( 0.1f );
     setWidth( 0.5f );
     setFeedback( 0.75f );
@@ -69,6 +71,7 @@ Flanger::~Flanger()
 {
     delete _delayFilter;
     delete _mixFilter;
+    delete sweep;
 
     while ( _buffers.size() > 0 ) {
         delete[] _buffers.back();
@@ -143,6 +146,21 @@ void Flanger::setMix( float value )
 }
 
 void Flanger::process( float* sampleBuffer, int bufferSize, int c )
+{
+    float sweepValues[ VST::LFO_BLOCK_SIZE ];
+
+    for ( int i = 0; i < bufferSize; i += VST::LFO_BLOCK_SIZE )
+    {
+        int blockSize = std::min( VST::LFO_BLOCK_SIZE, bufferSize - i );
+
+        for ( int j = 0; j < blockSize; ++j )
+            sweepValues[ j ] = sweep->peek();
+
+        process( sampleBuffer + i, blockSize, c, sweepValues );
+    }
+}
+
+void Flanger::process( float* sampleBuffer, int bufferSize, int c, const float* sweepValues )
 {
     float* delayBuffer = _buffers.at( c );
     int maxWriteIndex = FLANGER_BUFFER_SIZE - 1;
@@ -162,7 +180,7 @@ void Flanger::process( float* sampleBuffer, int bufferSize, int c )
 
         // delay 0.0-1.0 maps to 0.02ms to 10ms (always have at least 1 sample of delay)
         delaySamples = ( delay * SAMPLE_MULTIPLIER ) + 1.f;
-        delaySamples += _sweep;
+        delaySamples += sweepValues[ i ];
 
         // build the two emptying pointers and do linear interpolation
         ep = ( float ) _writePointer - delaySamples;
@@ -187,28 +205,13 @@ void Flanger::process( float* sampleBuffer, int bufferSize, int c )
         delayBuffer[ _writePointer ] = sample + _feedback * _feedbackPhase * _lastChannelSamples.at( c );
         _lastChannelSamples.at( c ) = delayBuffer[ ep1 ] * w1 + delayBuffer[ ep2 ] * w2;
         sampleBuffer[ i ] = Calc::capSample( _mixLeftDry * sample + _mixLeftWet * mix * _lastChannelSamples.at( c ));
-
-        // process sweep
-
-        if ( _step != 0.0 )
-        {
-            _sweep += _step;
-
-            if ( _sweep <= 0.0 )
-            {
-                _sweep = 0.0;
-                _step = -_step;
-            }
-            else if ( _sweep >= _maxSweepSamples)
-                _step = -_step;
-        }
     }
 }
 
 void Flanger::store()
 {
     _writePointerStored = _writePointer;
-    _sweepStored = _sweep;
+    sweep->store();
     _delayFilter->store();
     _mixFilter->store();
 }
@@ -216,18 +219,71 @@ void Flanger::store()
 void Flanger::restore()
 {
     _writePointer = _writePointerStored;
-    _sweep = _sweepStored;
+    sweep->restore();
     _delayFilter->restore();
     _mixFilter->restore();
 }
 
+void Flanger::reset()
+{
+    for ( size_t c = 0; c < _buffers.size(); ++c ) {
+        memset( _buffers.at( c ), 0, FLANGER_BUFFER_SIZE * sizeof( float ));
+        _lastChannelSamples.at( c ) = 0.f;
+    }
+    _writePointer = 0;
+    _delayFilter->reset();
+    _mixFilter->reset();
+
+    calculateSweep();
+}
+
+void Flanger::advance( int bufferSize )
+{
+    advanceDelay( bufferSize );
+    sweep->advance( bufferSize );
+}
+
+void Flanger::advanceDelay( int bufferSize )
+{
+    int maxWriteIndex = FLANGER_BUFFER_SIZE - 1;
+
+    // the filters smoothing the delay and mix settle onto their values within a fraction
+    // of a second, after which they no longer need processing
+
+    int settledSamples = 0;
+
+    for ( int i = 0; i < bufferSize; i++ )
+    {
+        if ( settledSamples < 2 ) {
+            _delayFilter->processSingle( _delay );
+            _mixFilter->processSingle( _mix );
+
+            settledSamples = ( _delayFilter->isSettled() && _mixFilter->isSettled() ) ? settledSamples + 1 : 0;
+        }
+
+        if ( ++_writePointer > maxWriteIndex )
+            _writePointer = 0;
+    }
+}
+
+int Flanger::getTailLength( float threshold )
+{
+    if ( _feedback >= 1.f )
+        return -1;
+
+    // each repeat takes at most the longest delay plus the full sweep
+
+    int period  = ( int ) ceil( SAMPLE_MULTIPLIER + 1.f + sweep->getRange() );
+    int repeats = ( _feedback > 0.f ) ? ( int ) ceil( log( threshold ) / log( _feedback )) : 0;
+
+    return ( repeats + 1 ) * period;
+}
+
 /* protected methods */
 
 void Flanger::calculateSweep()
 {
     // translate sweep rate to samples per second
-    _step = ( float ) ( _sweepSamples * 2.f * _sweepRate ) / _sampleRate;
-    _maxSweepSamples = _sweepSamples;
-    _sweep = 0.f;
+    sweep->setRange( _sweepSamples, ( float ) ( _sweepSamples * 2.f * _sweepRate ) / _sampleRate );
 }
 }
@@ -25,6 +25,7 @@
 #define __FLANGER_H_INCLUDED__
 
 #include "lowpassfilter.h"
+#include "sweep.h"
 #include <vector>
 
 // Adaptation of modf() by Dennis Cronin
@@ -59,6 +60,11 @@ class Flanger
 
         void process( float* sampleBuffer, int bufferSize, int c );
 
+        // as above, with the delay following given sweep values (one per sample, e.g.
+        // as rendered by the ModulationBus) instead of the own sweep moving along
+
+        void process( float* sampleBuffer, int bufferSize, int c, const float* sweepValues );
+
         // store/restore the processor properties
         // this ensures that multi channel processing for a
         // single buffer uses all properties across all channels
@@ -66,6 +72,26 @@ class Flanger
         void store();
         void restore();
 
+        // clears the flanger delay memory and restarts the sweep
+
+        void reset();
+
+        // moves the sweep and the parameter smoothing along by given
+        // amount of samples without processing
+
+        void advance( int bufferSize );
+
+        // as above, leaving the sweep in place (e.g. when the ModulationBus moves it along)
+
+        void advanceDelay( int bufferSize );
+
+        // the amount of samples the feedback takes to decay below given (linear)
+        // threshold, or -1 when the feedback does not decay
+
+        int getTailLength( float threshold );
+
+        Sweep* sweep;
+
     protected:
 
         float _rate;
@@ -75,13 +101,9 @@ class Flanger
         float _mix;
         float _feedbackPhase;
         float _sweepSamples;
-        float _maxSweepSamples;
         int _writePointer;
-        float _step;
-        float _sweep;
 
         int _writePointerStored;
-        float _sweepStored;
 
         std::vector<float*> _buffers;
         std::vector<float>  _lastChannelSamples;
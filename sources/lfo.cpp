@@ -21,6 +21,7 @@
  * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "lfo.h"
+#include <algorithm>
 
 namespace Igorski {
 
@@ -28,6 +29,9 @@ LFO::LFO( float sampleRate ) {
     _sampleRate  = sampleRate;
     _rate        = VST::MIN_LFO_RATE();
     _accumulator = 0.f;
+    _tableScale  = ( float ) WaveTables::SIZE / sampleRate;
+
+    setShape( WaveTables::kSine );
 }
 
 LFO::~LFO() {
@@ -46,6 +50,17 @@ void LFO::setRate( float value )
     _rate = value;
 }
 
+int LFO::getShape()
+{
+    return _shape;
+}
+
+void LFO::setShape( int shape )
+{
+    _shape = std::max( 0, std::min( shape, WaveTables::kNumShapes - 1 ));
+    _table = WaveTables::get( _shape );
+}
+
 void LFO::setAccumulator( float value )
 {
     _accumulator = value;
@@ -56,4 +71,16 @@ float LFO::getAccumulator()
     return _accumulator;
 }
 
+void LFO::advance( int samples )
+{
+    float sampleRate = _sampleRate;
+
+    for ( int i = 0; i < samples; ++i ) {
+        _accumulator += _rate;
+
+        if ( _accumulator > sampleRate )
+            _accumulator -= sampleRate;
+    }
+}
+
 }
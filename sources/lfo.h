@@ -24,6 +24,7 @@
 #define __LFO_H_INCLUDED__
 
 #include "global.h"
+#include "wavetables.h"
 
 namespace Igorski {
 class LFO {
@@ -35,12 +36,23 @@ class LFO {
         float getRate();
         void setRate( float value );
 
+        // the waveform of the oscillator (see WaveTables::Shape), changing
+        // the shape keeps the position of the oscillator within its cycle
+
+        int getShape();
+        void setShape( int shape );
+
         // accumulators are used to retrieve a sample from the wave table
         // in other words: track the progress of the oscillator against its range
 
         float getAccumulator();
         void setAccumulator( float offset );
 
+        // moves the accumulator along by given amount of samples, as if
+        // peek() had been invoked as many times
+
+        void advance( int samples );
+
         /**
          * retrieve a value from the wave table for the current
          * accumulator position, this method also increments
@@ -50,9 +62,13 @@ class LFO {
         {
             float sampleRate = _sampleRate;
 
-            // the wave table offset to read from
-            float SR_OVER_LENGTH = sampleRate / ( float ) TABLE_SIZE;
-            int readOffset = ( _accumulator == 0.f ) ? 0 : ( int ) ( _accumulator / SR_OVER_LENGTH );
+            // the position within the wave table, interpolated in between its entries. As the
+            // accumulator ranges up to and including the sample rate, the position can reach
+            // the end of the table, which the guard points after the table account for
+            float position = _accumulator * _tableScale;
+            int readOffset = ( int ) position;
+            float fraction = position - ( float ) readOffset;
+            float value    = _table[ readOffset ] + ( _table[ readOffset + 1 ] - _table[ readOffset ] ) * fraction;
 
             // increment the accumulators read offset
             _accumulator += _rate;
@@ -61,19 +77,19 @@ class LFO {
             if ( _accumulator > sampleRate )
                 _accumulator -= sampleRate;
 
-            // return the sample present at the calculated offset within the table
-            return VST::TABLE[ readOffset ];
+            return value;
         }
 
     private:
 
-        // see Igorski::VST::LFO_TABLE;
-        static const int TABLE_SIZE = 128;
-
         // used internally
 
         float _rate;
         float _accumulator;   // is read offset in wave table buffer
+        float _tableScale;    // translates the accumulator into a wave table position
+
+        const float* _table;
+        int _shape;
 
         float _sampleRate;
 };
@@ -25,6 +25,7 @@
  */
 #include "limiter.h"
 #include "global.h"
+#include <algorithm>
 #include <math.h>
 
 // constructors / destructor
@@ -66,9 +67,82 @@ void Limiter::setThreshold( float thresholdDb )
 
 float Limiter::getLinearGR()
 {
+    if ( lookahead > 0 )
+        return lookaheadGain;
+
     return gain > 1.f ? 1.f / gain : 1.f;
 }
 
+void Limiter::prepareLookahead( int maxSamples, int numChannels, float sampleRate )
+{
+    maxLookahead      = std::max( 0, maxSamples );
+    lookaheadChannels = std::max( 0, std::min( numChannels, MAX_LOOKAHEAD_CHANNELS ));
+    lookahead         = std::min( lookahead, maxLookahead );
+    lookaheadRelease  = 1.f - expf( -1.f / ( LOOKAHEAD_RELEASE_MS * .001f * sampleRate ));
+
+    if ( !truePeakKernel )
+        truePeakKernel = Igorski::TableRegistry::acquire( Igorski::TableRegistry::kTruePeakKernel, sampleRate );
+
+    // the hold and smoothing span the lookahead and the current frame
+
+    int history = std::max( maxLookahead + TRUE_PEAK_DELAY, TRUE_PEAK_TAPS - 1 );
+
+    delayLines.assign( lookaheadChannels * ( history + LOOKAHEAD_BLOCK ), 0.f );
+    holdGains.assign( maxLookahead + 1, 1.f );
+    holdExpiry.assign( maxLookahead + 1, 0 );
+    smoothGains.assign( maxLookahead + 1, 1.f );
+
+    resetLookahead();
+}
+
+void Limiter::setLookahead( int samples )
+{
+    samples = std::max( 0, std::min( samples, maxLookahead ));
+
+    if ( samples == lookahead )
+        return;
+
+    lookahead = samples;
+    resetLookahead();
+}
+
+int Limiter::getLookahead()
+{
+    return lookahead;
+}
+
+void Limiter::setCeiling( float ceilingDb )
+{
+    ceiling = powf( 10.f, ceilingDb / 20.f );
+}
+
+int Limiter::getLatency()
+{
+    return ( lookahead > 0 ) ? lookahead + TRUE_PEAK_DELAY : 0;
+}
+
+void Limiter::reset()
+{
+    gain = 1.f;
+    resetLookahead();
+}
+
+int Limiter::getTailLength( float threshold )
+{
+    // the lookahead and true peak detection delay the signal, the smoothing spans as
+    // many frames as the lookahead and the release starts when the last peak has passed
+
+    if ( lookahead > 0 )
+        return 2 * lookahead + 1 + TRUE_PEAK_DELAY + ( int ) ceil( log( threshold ) / log( 1.f - lookaheadRelease ));
+
+    // without release a reduced gain is held indefinitely
+
+    if ( rel <= 0.f )
+        return ( gain < 1.f ) ? -1 : 0;
+
+    return ( int ) ceil( log( threshold ) / log( 1.f - rel ));
+}
+
 /* protected methods */
 
 void Limiter::init( float attackMs, float releaseMs, float thresholdDb )
@@ -81,7 +155,29 @@ void Limiter::init( float attackMs, float releaseMs, float thresholdDb )
 
     gain = 1.f;
 
+    maxLookahead      = 0;
+    lookahead         = 0;
+    lookaheadChannels = 0;
+    lookaheadRelease  = 1.f;
+    ceiling           = 1.f;
+
     recalculate();
+    resetLookahead();
+}
+
+void Limiter::resetLookahead()
+{
+    std::fill( delayLines.begin(), delayLines.end(), 0.f );
+    std::fill( smoothGains.begin(), smoothGains.end(), 1.f );
+    std::fill( truePeakLevels, truePeakLevels + MAX_LOOKAHEAD_CHANNELS, 0.f );
+
+    lookaheadGain = 1.f;
+    envelope      = 1.f;
+    holdFront     = 0;
+    holdCount     = 0;
+    holdTime      = 0;
+    smoothIndex   = 0;
+    smoothSum     = lookahead + 1;
 }
 
 void Limiter::recalculate()
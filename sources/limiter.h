@@ -27,9 +27,47 @@
 #define __LIMITER_H_INCLUDED__
 
 #include "audiobuffer.h"
+#include "tableregistry.h"
+#include <algorithm>
+#include <vector>
+#include <math.h>
 
+/**
+ * the limiter either runs as the feedback limiter of the original plugin, or when
+ * a lookahead is set, as a lookahead limiter keeping the output below a ceiling
+ *
+ * the lookahead limiter delays the signal by the lookahead. The gain each frame
+ * requires to stay below the ceiling is held at its minimum for the length of the
+ * lookahead, then released and smoothed by averaging over the same length. The gain
+ * applied onto a frame thus never exceeds the gain it requires, while reductions
+ * fade in over the lookahead rather than abruptly
+ *
+ * the level of a frame is its true peak: besides the sample itself, the signal is
+ * interpolated at four times the sample rate on either side of it, catching the peaks
+ * between samples which a sample peak limiter lets through (and which clip once the
+ * signal is converted to analog or resampled). The interpolation only feeds the gain
+ * computation, the delayed signal is left untouched. The interpolated points are known
+ * TRUE_PEAK_DELAY frames after the frame they surround, which adds to the latency
+ */
 class Limiter
 {
+    // the amount of frames processed at a time in lookahead mode
+
+    static const int LOOKAHEAD_BLOCK = 64;
+
+    // the maximum amount of channels limited in lookahead mode
+
+    static const int MAX_LOOKAHEAD_CHANNELS = 8;
+
+    // the release time of the lookahead limiter
+
+    const float LOOKAHEAD_RELEASE_MS = 80.f;
+
+    // the delay of the true peak detection, see TableRegistry::kTruePeakKernel
+
+    static const int TRUE_PEAK_TAPS  = Igorski::TableRegistry::TRUE_PEAK_TAPS;
+    static const int TRUE_PEAK_DELAY = TRUE_PEAK_TAPS / 2;
+
     public:
         Limiter();
         Limiter( float attackMs, float releaseMs, float thresholdDb );
@@ -38,14 +76,70 @@ class Limiter
         template <typename SampleType>
         void process( SampleType** outputBuffer, int bufferSize, int numOutChannels );
 
+        // as above for interleaved frames of numChannels samples, the feedback limiter
+        // limits the first two channels
+
+        template <typename SampleType>
+        void processInterleaved( SampleType* outputBuffer, int bufferSize, int numChannels );
+
         void setAttack( float attackMs );
         void setRelease( float releaseMs );
         void setThreshold( float thresholdDb );
 
         float getLinearGR();
 
+        // allocates the memory for lookaheads of up to given amount of samples for up to
+        // given amount of channels (channels beyond are left as is in lookahead mode)
+
+        void prepareLookahead( int maxSamples, int numChannels, float sampleRate );
+
+        // the lookahead in samples, clamped to the prepared maximum. 0 selects the feedback limiter.
+        // Changing the lookahead clears the signal being delayed
+
+        void setLookahead( int samples );
+        int getLookahead();
+
+        // the level the lookahead limiter keeps the output below
+
+        void setCeiling( float ceilingDb );
+
+        // the delay of the output relative to the input, in samples
+
+        int getLatency();
+
+        // releases any gain reduction in progress
+
+        void reset();
+
+        // the amount of samples the gain takes to recover from full reduction to
+        // within given (linear) threshold of unity, or -1 when it does not recover
+
+        int getTailLength( float threshold );
+
+        // the coefficients of the hard knee gain computer, these allow
+        // other processors to apply the same limiting to their signals
+
+        float getThresholdCoefficient() { return thresh; }
+        float getAttackCoefficient()    { return att; }
+        float getReleaseCoefficient()   { return rel; }
+        float getTrimCoefficient()      { return trim; }
+
     protected:
         void init( float attackMs, float releaseMs, float thresholdDb );
+
+        // limits the samples of the left and right channel found every stride
+        // samples from given buffers (rightBuffer is 0 for mono signals)
+
+        template <typename SampleType>
+        void process( SampleType* leftBuffer, SampleType* rightBuffer, int stride, int bufferSize );
+
+        // limits the samples of given channels found every stride samples in lookahead mode
+
+        template <typename SampleType>
+        void processLookahead( SampleType* const* buffers, int numChannels, int stride, int bufferSize );
+
+        void resetLookahead();
+
         void recalculate();
 
         float pTresh;   // in dB, -20 - 20
@@ -55,6 +149,41 @@ class Limiter
         float pKnee;
 
         float thresh, gain, att, rel, trim;
+
+        // lookahead mode
+
+        int maxLookahead;
+        int lookahead;
+        int lookaheadChannels;
+        float ceiling;          // linear
+        float lookaheadRelease; // coefficient
+        float lookaheadGain;    // the gain applied onto the last frame
+        float envelope;         // the held gain after release
+
+        // the signal being delayed, per channel the lookahead and true peak delay (or at least
+        // the taps of the true peak kernel) followed by a block of frames
+
+        std::vector<float> delayLines;
+
+        // the true peak kernel and the highest interpolated level between the last two frames per channel
+
+        Igorski::TableRegistry::Table truePeakKernel;
+        float truePeakLevels[ MAX_LOOKAHEAD_CHANNELS ];
+
+        // the minimum of the required gain over the lookahead is tracked by a monotonic deque
+        // of the gains that can still become the minimum, each with the time it expires
+
+        std::vector<float> holdGains;
+        std::vector<uint32_t> holdExpiry;
+        int holdFront;
+        int holdCount;
+        uint32_t holdTime;
+
+        // the released gains averaged for smoothing
+
+        std::vector<float> smoothGains;
+        int smoothIndex;
+        double smoothSum;
 };
 
 #include "limiter.tcc"
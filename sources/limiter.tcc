@@ -25,6 +25,161 @@
  */
 template <typename SampleType>
 void Limiter::process( SampleType** outputBuffer, int bufferSize, int numOutChannels )
+{
+    if ( lookahead > 0 )
+        processLookahead( outputBuffer, numOutChannels, 1, bufferSize );
+    else
+        process( outputBuffer[ 0 ], ( numOutChannels > 1 ) ? outputBuffer[ 1 ] : 0, 1, bufferSize );
+}
+
+template <typename SampleType>
+void Limiter::processInterleaved( SampleType* outputBuffer, int bufferSize, int numChannels )
+{
+    if ( lookahead > 0 ) {
+        SampleType* buffers[ MAX_LOOKAHEAD_CHANNELS ];
+        int channels = std::min( numChannels, MAX_LOOKAHEAD_CHANNELS );
+
+        for ( int c = 0; c < channels; ++c )
+            buffers[ c ] = outputBuffer + c;
+
+        processLookahead( buffers, channels, numChannels, bufferSize );
+    }
+    else
+        process( outputBuffer, ( numChannels > 1 ) ? outputBuffer + 1 : 0, numChannels, bufferSize );
+}
+
+template <typename SampleType>
+void Limiter::processLookahead( SampleType* const* buffers, int numChannels, int stride, int bufferSize )
+{
+    const int PHASES = Igorski::TableRegistry::TRUE_PEAK_PHASES;
+
+    int channels   = std::min( numChannels, lookaheadChannels );
+    int length     = lookahead + 1; // of the hold and the smoothing
+    int delay      = lookahead + TRUE_PEAK_DELAY;
+    int history    = std::max( delay, TRUE_PEAK_TAPS - 1 ); // frames kept in the delay lines
+    int lineLength = std::max( maxLookahead + TRUE_PEAK_DELAY, TRUE_PEAK_TAPS - 1 ) + LOOKAHEAD_BLOCK;
+    int capacity   = maxLookahead + 1;
+
+    const float* kernel = truePeakKernel->getData();
+
+    float peaks [ LOOKAHEAD_BLOCK ];
+    float gains [ LOOKAHEAD_BLOCK ];
+    float levels[ LOOKAHEAD_BLOCK + 1 ];
+
+    for ( int offset = 0; offset < bufferSize; offset += LOOKAHEAD_BLOCK )
+    {
+        int frames = std::min( LOOKAHEAD_BLOCK, bufferSize - offset );
+
+        // append the trimmed frames to the delay lines and find the true peak level of
+        // the frames TRUE_PEAK_DELAY frames before them
+
+        for ( int i = 0; i < frames; ++i )
+            peaks[ i ] = 0.f;
+
+        for ( int c = 0; c < channels; ++c ) {
+            const SampleType* in = buffers[ c ] + ( size_t ) offset * stride;
+            float* line          = &delayLines[ c * lineLength ];
+
+            for ( int i = 0; i < frames; ++i )
+                line[ history + i ] = ( float ) in[ i * stride ] * trim;
+
+            // interpolate the points between each pair of frames, one phase of the kernel at a
+            // time. The loops run over the frames so they vectorize without horizontal sums
+
+            const float* taps = line + history - ( TRUE_PEAK_TAPS - 1 );
+
+            levels[ 0 ] = truePeakLevels[ c ];
+            for ( int i = 0; i < frames; ++i )
+                levels[ i + 1 ] = 0.f;
+
+            for ( int p = 0; p < PHASES; ++p ) {
+                float coefficients[ TRUE_PEAK_TAPS ];
+                for ( int j = 0; j < TRUE_PEAK_TAPS; ++j )
+                    coefficients[ j ] = kernel[ j * PHASES + p ];
+
+                for ( int i = 0; i < frames; ++i ) {
+                    float point = 0.f;
+                    for ( int j = 0; j < TRUE_PEAK_TAPS; ++j )
+                        point += coefficients[ j ] * taps[ i + j ];
+
+                    float level     = fabsf( point );
+                    levels[ i + 1 ] = level > levels[ i + 1 ] ? level : levels[ i + 1 ];
+                }
+            }
+            truePeakLevels[ c ] = levels[ frames ];
+
+            // the level of a frame is the highest of the sample and the points on either side
+
+            const float* detected = line + history - TRUE_PEAK_DELAY;
+
+            for ( int i = 0; i < frames; ++i ) {
+                float level = fabsf( detected[ i ]);
+                level       = levels[ i ]     > level ? levels[ i ]     : level;
+                level       = levels[ i + 1 ] > level ? levels[ i + 1 ] : level;
+                peaks[ i ]  = level > peaks[ i ] ? level : peaks[ i ];
+            }
+        }
+
+        // the gain each frame requires to stay below the ceiling
+
+        for ( int i = 0; i < frames; ++i )
+            gains[ i ] = ceiling / ( peaks[ i ] > ceiling ? peaks[ i ] : ceiling );
+
+        // hold the minimum required gain over the lookahead, release and smooth it
+
+        for ( int i = 0; i < frames; ++i, ++holdTime )
+        {
+            float required = gains[ i ];
+
+            if ( holdCount > 0 && ( int32_t )( holdExpiry[ holdFront ] - holdTime ) <= 0 ) {
+                holdFront = ( holdFront + 1 == capacity ) ? 0 : holdFront + 1;
+                --holdCount;
+            }
+
+            // gains no lower than the required gain can no longer become the minimum
+
+            int back = holdFront + holdCount;
+            back    -= ( back >= capacity ) ? capacity : 0;
+
+            while ( holdCount > 0 ) {
+                int last = ( back == 0 ) ? capacity - 1 : back - 1;
+                if ( holdGains[ last ] < required )
+                    break;
+                back = last;
+                --holdCount;
+            }
+            holdGains [ back ] = required;
+            holdExpiry[ back ] = holdTime + length;
+            ++holdCount;
+
+            float held = holdGains[ holdFront ];
+            envelope   = ( held < envelope ) ? held : envelope + lookaheadRelease * ( held - envelope );
+
+            smoothSum += envelope - smoothGains[ smoothIndex ];
+            smoothGains[ smoothIndex ] = envelope;
+            smoothIndex = ( smoothIndex + 1 == length ) ? 0 : smoothIndex + 1;
+
+            gains[ i ] = ( float )( smoothSum / length );
+        }
+
+        // apply the gain onto the delayed frames and move the delay lines along
+
+        for ( int c = 0; c < channels; ++c ) {
+            SampleType* out = buffers[ c ] + ( size_t ) offset * stride;
+            float* line     = &delayLines[ c * lineLength ];
+            float* delayed  = line + history - delay;
+
+            for ( int i = 0; i < frames; ++i )
+                out[ i * stride ] = ( SampleType )( delayed[ i ] * gains[ i ] );
+
+            memmove( line, line + frames, history * sizeof( float ));
+        }
+        lookaheadGain = gains[ frames - 1 ];
+    }
+}
+
+template <typename SampleType>
+void Limiter::process( SampleType* leftBuffer, SampleType* rightBuffer, int stride, int bufferSize )
 {
 //    if ( gain > 0.9999f && outputBuffer->isSilent )
 //    {
@@ -40,10 +195,7 @@ void Limiter::process( SampleType** outputBuffer, int bufferSize, int numOutChan
     re = rel;
     tr = trim;
 
-    bool hasRight = ( numOutChannels > 1 );
-
-    SampleType* leftBuffer  = outputBuffer[ 0 ];
-    SampleType* rightBuffer = hasRight ? outputBuffer[ 1 ] : 0;
+    bool hasRight = ( rightBuffer != 0 );
 
     if ( pKnee > 0.5 )
     {
@@ -51,8 +203,8 @@ void Limiter::process( SampleType** outputBuffer, int bufferSize, int numOutChan
 
         for ( int i = 0; i < bufferSize; ++i ) {
 
-            ol  = leftBuffer[ i ];
-            or_ = hasRight ? rightBuffer[ i ] : 0;
+            ol  = leftBuffer[ i * stride ];
+            or_ = hasRight ? rightBuffer[ i * stride ] : 0;
 
             lev = ( SampleType ) ( 1.f / ( 1.f + th * fabs( ol + or_ )));
 
@@ -63,18 +215,18 @@ void Limiter::process( SampleType** outputBuffer, int bufferSize, int numOutChan
                 g = g + re * ( lev - g );
             }
 
-            leftBuffer[ i ] = ( ol * tr * g );
+            leftBuffer[ i * stride ] = ( ol * tr * g );
 
             if ( hasRight )
-                rightBuffer[ i ] = ( or_ * tr * g );
+                rightBuffer[ i * stride ] = ( or_ * tr * g );
         }
     }
     else
     {
         for ( int i = 0; i < bufferSize; ++i ) {
 
-            ol  = leftBuffer[ i ];
-            or_ = hasRight ? rightBuffer[ i ] : 0;
+            ol  = leftBuffer[ i * stride ];
+            or_ = hasRight ? rightBuffer[ i * stride ] : 0;
 
             lev = ( SampleType ) ( 0.5 * g * fabs( ol + or_ ));
 
@@ -86,10 +238,10 @@ void Limiter::process( SampleType** outputBuffer, int bufferSize, int numOutChan
                 g = g + ( SampleType )( re * ( 1.f - g ));
             }
 
-            leftBuffer[ i ] = ( ol * tr * g );
+            leftBuffer[ i * stride ] = ( ol * tr * g );
 
             if ( hasRight )
-                rightBuffer[ i ] = ( or_ * tr * g );
+                rightBuffer[ i * stride ] = ( or_ * tr * g );
         }
     }
     gain = g;
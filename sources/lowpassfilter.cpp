@@ -78,6 +78,16 @@ void LowPassFilter::restore()
     y2 = orgy2;
 }
 
+void LowPassFilter::reset()
+{
+    x1 = x2 = y1 = y2 = 0;
+}
+
+bool LowPassFilter::isSettled()
+{
+    return x1 == x2 && y1 == y2;
+}
+
 float LowPassFilter::processSingle( float sample )
 {
     float sampleOut = (b0/a0) * sample + (b1/a0) * x1 + (b2/a0) * x2 - (a1/a0) * y1 - (a2/a0) * y2;
@@ -43,6 +43,16 @@ class LowPassFilter
         void store();
         void restore();
 
+        // clears the filter history
+
+        void reset();
+
+        // whether the last two inputs and the last two outputs are equal. When this holds
+        // for two consecutive samples of the same input, the filter has settled onto it and
+        // processing that input any further leaves the filter unchanged
+
+        bool isSettled();
+
         float processSingle( float sample );
 
     protected:
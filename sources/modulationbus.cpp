@@ -0,0 +1,106 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "modulationbus.h"
+#include <string.h>
+
+namespace Igorski {
+
+/* constructor / destructor */
+
+ModulationBus::ModulationBus()
+{
+    _bufferSize      = 0;
+    _controlInterval = 1;
+
+    for ( int i = 0; i < kNumSources; ++i ) {
+        _controls[ i ]         = 0;
+        _valuesStored[ i ]     = 0.f;
+        _countdownsStored[ i ] = 0;
+    }
+
+    reset();
+}
+
+ModulationBus::~ModulationBus()
+{
+    for ( int i = 0; i < kNumSources; ++i )
+        delete[] _controls[ i ];
+}
+
+/* public methods */
+
+void ModulationBus::setMaxBufferSize( int bufferSize )
+{
+    if ( bufferSize <= _bufferSize )
+        return;
+
+    for ( int i = 0; i < kNumSources; ++i ) {
+        delete[] _controls[ i ];
+        _controls[ i ] = new float[ bufferSize ];
+        memset( _controls[ i ], 0, bufferSize * sizeof( float ));
+    }
+    _bufferSize = bufferSize;
+}
+
+int ModulationBus::getControlInterval()
+{
+    return _controlInterval;
+}
+
+void ModulationBus::setControlInterval( int samples )
+{
+    samples = std::max( 1, samples );
+
+    if ( samples == _controlInterval )
+        return;
+
+    _controlInterval = samples;
+    reset();
+}
+
+const float* ModulationBus::getControl( Source source )
+{
+    return _controls[ source ];
+}
+
+void ModulationBus::store( Source source )
+{
+    _valuesStored[ source ]     = _values[ source ];
+    _countdownsStored[ source ] = _countdowns[ source ];
+}
+
+void ModulationBus::restore( Source source )
+{
+    _values[ source ]     = _valuesStored[ source ];
+    _countdowns[ source ] = _countdownsStored[ source ];
+}
+
+void ModulationBus::reset()
+{
+    for ( int i = 0; i < kNumSources; ++i ) {
+        _values[ i ]     = 0.f;
+        _countdowns[ i ] = 0;
+    }
+}
+
+}
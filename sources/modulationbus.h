@@ -0,0 +1,123 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __MODULATIONBUS_H_INCLUDED__
+#define __MODULATIONBUS_H_INCLUDED__
+
+#include <algorithm>
+
+namespace Igorski {
+
+/**
+ * renders the oscillators modulating the effects once per block into control
+ * buffers holding a value per sample, which the effects then read for each
+ * channel and each placement in the chain, instead of stepping their own
+ * oscillators. Oscillators are read at the control rate, holding their value
+ * in between, which lets the effects skip the recalculation of their properties
+ */
+class ModulationBus {
+
+    public:
+        enum Source {
+            kBitCrusherLFO = 0,
+            kFilterLFO,
+            kFlangerSweep,
+            kNumSources
+        };
+
+        ModulationBus();
+        ~ModulationBus();
+
+        // creates the control buffers for rendering up to given amount of samples,
+        // after which render() does not allocate for that amount or less
+
+        void setMaxBufferSize( int bufferSize );
+
+        // the amount of samples in between reading the oscillators, where
+        // 1 reads them for every sample (at the audio rate)
+
+        int getControlInterval();
+        void setControlInterval( int samples );
+
+        // renders given oscillator (anything with the peek() and advance() methods of
+        // the LFO) into the control buffer of given source, starting at given offset. The
+        // control points lie on a fixed grid, so the values do not depend on the sizes of
+        // the rendered blocks
+
+        template <typename Oscillator>
+        void render( Source source, Oscillator* oscillator, int bufferSize, int offset = 0 )
+        {
+            float* control = _controls[ source ] + offset;
+
+            if ( _controlInterval == 1 ) {
+                for ( int i = 0; i < bufferSize; ++i )
+                    control[ i ] = oscillator->peek();
+                return;
+            }
+
+            int countdown = _countdowns[ source ];
+            float value   = _values[ source ];
+
+            for ( int i = 0; i < bufferSize; )
+            {
+                if ( countdown == 0 ) {
+                    value = oscillator->peek();
+                    oscillator->advance( _controlInterval - 1 );
+                    countdown = _controlInterval;
+                }
+                int hold = std::min( countdown, bufferSize - i );
+
+                std::fill( control + i, control + i + hold, value );
+
+                countdown -= hold;
+                i += hold;
+            }
+            _countdowns[ source ] = countdown;
+            _values[ source ]     = value;
+        }
+
+        // the control buffer of given source, as last rendered
+
+        const float* getControl( Source source );
+
+        // store/restore the position on the control grid of given source, for oscillators
+        // which are rendered for each channel in turn from the same position
+
+        void store( Source source );
+        void restore( Source source );
+
+        // restarts the control grid, the next render() reads the oscillators on its first sample
+
+        void reset();
+
+    private:
+        float* _controls[ kNumSources ];
+        float _values[ kNumSources ];  // the value held until the next control point
+        int _countdowns[ kNumSources ]; // the amount of samples until the next control point
+        float _valuesStored[ kNumSources ];
+        int _countdownsStored[ kNumSources ];
+        int _bufferSize;
+        int _controlInterval;
+};
+}
+
+#endif
@@ -0,0 +1,64 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __PARAMDEFAULTS_H_INCLUDED__
+#define __PARAMDEFAULTS_H_INCLUDED__
+
+#include "global.h"
+#include "paramids.h"
+
+/**
+ * the default values of the parameters listed in paramids.h, normalized to
+ * the 0 - 1 range. Both the RegraderModel and the parameter descriptions of
+ * the plugin (which scale them onto their own ranges) start out from these
+ */
+namespace Igorski {
+namespace ParamDefaults {
+
+    inline float getValue( int id )
+    {
+        switch ( id )
+        {
+            case kDelayTimeId:             return .125f;
+            case kDelayHostSyncId:         return 1.f;
+            case kDelayFeedbackId:         return .2f;
+            case kDelayMixId:              return .5f;
+            case kBitResolutionId:         return 1.f;  // 16 bits
+            case kBitResolutionChainId:    return 1.f;
+            case kLFOBitResolutionDepthId: return .75f;
+            case kDecimatorId:             return 1.f;  // 32 bits
+
+            // half the maximum frequency
+
+            case kFilterCutoffId:
+                return ( VST::FILTER_MAX_FREQ * .5f - VST::FILTER_MIN_FREQ ) / ( VST::FILTER_MAX_FREQ - VST::FILTER_MIN_FREQ );
+
+            case kFilterResonanceId:       return 1.f;
+            case kLFOFilterDepthId:        return .5f;
+            case kLimiterCeilingId:        return 11.f / 12.f; // -1 dBTP
+            default:                       return 0.f;
+        }
+    }
+}
+}
+
+#endif
@@ -55,6 +55,27 @@ enum
 
     kVuPPMId,                 // for the Vu value return to host
 
+    // controls added after the port are appended here, which
+    // keeps the indices of the original parameters unchanged
+
+    kBitResolutionLoopId,     // bit resolution in delay feedback loop
+    kDecimatorLoopId,         // decimator in delay feedback loop
+    kFilterLoopId,            // filter in delay feedback loop
+
+    kDspLoadId,               // for the average DSP load return to host
+    kDspLoadPeakId,           // for the peak DSP load return to host
+
+    kLimiterLookaheadId,      // limiter lookahead (0 = no lookahead)
+    kLimiterCeilingId,        // limiter true peak ceiling in lookahead mode
+
+    kFilterTypeId,            // filter type (see Filter::Type)
+    kFilterSlopeId,           // filter slope (see Filter::Slope)
+
+    kLFOBitResolutionShapeId, // bit resolution LFO shape (see WaveTables::Shape)
+    kLFOFilterShapeId,        // filter LFO shape (see WaveTables::Shape)
+
+    kTransportResetId,        // reset the effect when the host transport jumps (plugin only)
+
     // jpc: the number of parameters
     kNumParameters,
 };
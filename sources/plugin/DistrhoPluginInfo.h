@@ -37,6 +37,7 @@
 #define DISTRHO_PLUGIN_NUM_INPUTS       2
 #define DISTRHO_PLUGIN_NUM_OUTPUTS      2
 #define DISTRHO_PLUGIN_WANT_TIMEPOS     1
+#define DISTRHO_PLUGIN_WANT_LATENCY     1
 #define DISTRHO_PLUGIN_WANT_PROGRAMS    0
 #define DISTRHO_PLUGIN_WANT_MIDI_INPUT  0
 #define DISTRHO_PLUGIN_WANT_MIDI_OUTPUT 0
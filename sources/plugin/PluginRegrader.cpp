@@ -25,7 +25,9 @@
 #include "SharedRegrader.hpp"
 #include "paramids.h"
 #include "calc.h"
+#include "rtcheck.h"
 #include <math.h>
+#include <chrono>
 
 namespace Igorski {
 
@@ -33,28 +35,14 @@ namespace Igorski {
 
 PluginRegrader::PluginRegrader()
     : Plugin(kNumParameters, 0, 0)
-    , fDelayTime( 0.125f )
-    , fDelayHostSync( 1.f )
-    , fDelayFeedback( 0.2f )
-    , fDelayMix( .5f )
-    , fBitResolution( 1.f )
-    , fBitResolutionChain( 1.f )
-    , fLFOBitResolution( .0f )
-    , fLFOBitResolutionDepth( .75f )
-    , fDecimator( 1.f )
-    , fDecimatorChain( 0.f )
-    , fLFODecimator( 0.f )
-    , fFilterChain( 1.f )
-    , fFilterCutoff( .5f )
-    , fFilterResonance( 1.f )
-    , fLFOFilter( 0.f )
-    , fLFOFilterDepth( 0.5f )
-    , fFlangerChain( 0.f )
-    , fFlangerRate( 0.f )
-    , fFlangerWidth( 0.f )
-    , fFlangerFeedback( 0.f )
-    , fFlangerDelay( 0.f )
-    , outputGain( 0.f )
+    , loadTime( 0.0 )
+    , loadFrames( 0 )
+    , loadWindow( 1 )
+    , loadPeak( 0.f )
+    , transportKnown( false )
+    , expectedFrame( 0 )
+    , silentFrames( 0 )
+    , suspended( false )
 {
     fParameterRanges = new ParameterRangesSimple[kNumParameters];
 
@@ -95,6 +83,8 @@ void PluginRegrader::initParameter(uint32_t index, Parameter& parameter) {
 void PluginRegrader::sampleRateChanged(double newSampleRate) {
     regraderProcess = new RegraderProcess( 2, newSampleRate );
 
+    loadWindow = std::max( 1u, ( uint32_t )( newSampleRate / LOAD_WINDOW_RATE ));
+
     syncModel();
 }
 
@@ -102,84 +92,9 @@ void PluginRegrader::sampleRateChanged(double newSampleRate) {
   Get the current value of a parameter.
 */
 float PluginRegrader::getParameterValue(uint32_t index) const {
-    float value;
-
-    switch (index) {
-    case kDelayTimeId:             // delay time
-        value = fDelayTime;
-        break;
-    case kDelayHostSyncId:         // delay host sync
-        value = fDelayHostSync;
-        break;
-    case kDelayFeedbackId:         // delay feedback
-        value = fDelayFeedback;
-        break;
-    case kDelayMixId:              // delay mix
-        value = fDelayMix;
-
-        break;
-    case kBitResolutionId:         // bit resolution
-        value = fBitResolution;
-        break;
-    case kBitResolutionChainId:    // bit resolution pre/post delay mix
-        value = fBitResolutionChain;
-        break;
-    case kLFOBitResolutionId:      // bit resolution LFO rate
-        value = fLFOBitResolution;
-        break;
-    case kLFOBitResolutionDepthId: // depth for bit resolution LFO
-        value = fLFOBitResolutionDepth;
-
-        break;
-    case kDecimatorId:             // decimator
-        value = fDecimator;
-        break;
-    case kDecimatorChainId:        // decimator pre/post delay mix
-        value = fDecimatorChain;
-        break;
-    case kLFODecimatorId:          // decimator LFO rate
-        value = fLFODecimator;
-
-        break;
-    case kFilterChainId:           // filter pre/post delay mix
-        value = fFilterChain;
-        break;
-    case kFilterCutoffId:          // filter cutoff
-        value = fFilterCutoff;
-        break;
-    case kFilterResonanceId:       // filter resonance
-        value = fFilterResonance;
-        break;
-    case kLFOFilterId:             // filter LFO rate
-        value = fLFOFilter;
-        break;
-    case kLFOFilterDepthId:        // depth for filter LFO
-        value = fLFOFilterDepth;
-
-        break;
-    case kFlangerChainId:          // flanger pre/post delay mix
-        value = fFlangerChain;
-        break;
-    case kFlangerRateId:           // flanger LFO rate
-        value = fFlangerRate;
-        break;
-    case kFlangerWidthId:          // flanger width
-        value = fFlangerWidth;
-        break;
-    case kFlangerFeedbackId:       // flanger feedback
-        value = fFlangerFeedback;
-        break;
-    case kFlangerDelayId:          // flanger delay
-        value = fFlangerDelay;
-        break;
-
-    case kVuPPMId:                 // for the Vu value return to host
-        value = outputGain;
-        break;
-
-    default:
-        DISTRHO_SAFE_ASSERT_RETURN(false, 0.0f);
-    }
+    DISTRHO_SAFE_ASSERT_RETURN(index < kNumParameters, 0.0f);
+
+    float value = model.getValue(index);
 
     ParameterRangesSimple range = fParameterRanges[index];
     return value * (range.max - range.min) + range.min;
@@ -194,82 +109,7 @@ void PluginRegrader::setParameterValue(uint32_t index, float value) {
     ParameterRangesSimple range = fParameterRanges[index];
     value = (value - range.min) / (range.max - range.min);
 
-    switch (index) {
-    case kDelayTimeId:             // delay time
-        fDelayTime = value;
-        break;
-    case kDelayHostSyncId:         // delay host sync
-        fDelayHostSync = value;
-        break;
-    case kDelayFeedbackId:         // delay feedback
-        fDelayFeedback = value;
-        break;
-    case kDelayMixId:              // delay mix
-        fDelayMix = value;
-        break;
-
-    case kBitResolutionId:         // bit resolution
-        fBitResolution = value;
-        break;
-    case kBitResolutionChainId:    // bit resolution pre/post delay mix
-        fBitResolutionChain = value;
-        break;
-    case kLFOBitResolutionId:      // bit resolution LFO rate
-        fLFOBitResolution = value;
-        break;
-    case kLFOBitResolutionDepthId: // depth for bit resolution LFO
-        fLFOBitResolutionDepth = value;
-        break;
-
-    case kDecimatorId:             // decimator
-        fDecimator = value;
-        break;
-    case kDecimatorChainId:        // decimator pre/post delay mix
-        fDecimatorChain = value;
-        break;
-    case kLFODecimatorId:          // decimator LFO rate
-        fLFODecimator = value;
-        break;
-
-    case kFilterChainId:           // filter pre/post delay mix
-        fFilterChain = value;
-        break;
-    case kFilterCutoffId:          // filter cutoff
-        fFilterCutoff = value;
-        break;
-    case kFilterResonanceId:       // filter resonance
-        fFilterResonance = value;
-        break;
-    case kLFOFilterId:             // filter LFO rate
-        fLFOFilter = value;
-        break;
-    case kLFOFilterDepthId:        // depth for filter LFO
-        fLFOFilterDepth = value;
-        break;
-
-    case kFlangerChainId:          // flanger pre/post delay mix
-        fFlangerChain = value;
-        break;
-    case kFlangerRateId:           // flanger LFO rate
-        fFlangerRate = value;
-        break;
-    case kFlangerWidthId:          // flanger width
-        fFlangerWidth = value;
-        break;
-    case kFlangerFeedbackId:       // flanger feedback
-        fFlangerFeedback = value;
-        break;
-    case kFlangerDelayId:          // flanger delay
-        fFlangerDelay = value;
-        break;
-
-    case kVuPPMId:                 // for the Vu value return to host
-        outputGain = value;
-        break;
-
-    default:
-        DISTRHO_SAFE_ASSERT_RETURN(false, );
-    }
+    model.setValue(index, value);
 
     syncModel();
 }
@@ -278,12 +118,22 @@ void PluginRegrader::setParameterValue(uint32_t index, float value) {
 // Process
 
 void PluginRegrader::activate() {
-    // plugin is activated
+    // plugin is activated, create the buffers before processing starts
+    regraderProcess->setMaxBufferSize( getBufferSize() );
+
+    // the transport position of the first run() is not a jump
+    transportKnown = false;
+    silentFrames   = 0;
+    suspended      = false;
 }
 
 
 
 void PluginRegrader::run(const float** inputs, float** outputs, uint32_t frames) {
+    REGRADER_RT_SCOPE;
+
+    std::chrono::steady_clock::time_point runStart = std::chrono::steady_clock::now();
+
     TimePosition timePos = getTimePosition();
     TimePosition::BarBeatTick bbt = timePos.bbt;
 
@@ -301,40 +151,109 @@ void PluginRegrader::run(const float** inputs, float** outputs, uint32_t frames)
     int32 numInChannels  = DISTRHO_PLUGIN_NUM_INPUTS;
     int32 numOutChannels = DISTRHO_PLUGIN_NUM_OUTPUTS;
 
-    // process the incoming sound!
-    regraderProcess->process<float>(
-        const_cast<float **>(inputs), outputs, numInChannels, numOutChannels,
-        frames, frames * sizeof(float)
-    );
+    if ( updateTransport( timePos, inputs, frames )) {
+        // the oscillators and delay positions move along as if the silence was processed
+        regraderProcess->advance( numInChannels, frames );
+
+        for ( int32 c = 0; c < numOutChannels; ++c )
+            memset( outputs[ c ], 0, frames * sizeof( float ));
+    }
+    else {
+        // process the incoming sound!
+        regraderProcess->process<float>(
+            const_cast<float **>(inputs), outputs, numInChannels, numOutChannels, frames
+        );
+    }
 
     // output flags
-    outputGain = regraderProcess->limiter->getLinearGR();
+    model.setValue( kVuPPMId, regraderProcess->limiter->getLinearGR() );
+
+    std::chrono::duration<double> runTime = std::chrono::steady_clock::now() - runStart;
+    updateDspLoad( runTime.count(), frames );
+}
+
+bool PluginRegrader::updateTransport(const TimePosition& timePos, const float** inputs, uint32_t frames)
+{
+    // a seek or loop jump discards the repeats of the audio preceding it, so the
+    // output after the jump does not depend on what was played before
+
+    if ( timePos.playing && transportKnown && timePos.frame != expectedFrame &&
+         Calc::toBool( model.getValue( kTransportResetId )))
+        regraderProcess->reset();
+
+    transportKnown = true;
+    expectedFrame  = timePos.frame + ( timePos.playing ? frames : 0 );
+
+    // idle while the transport is stopped and the input is silent
+
+    bool idle = !timePos.playing;
+
+    for ( int32 c = 0; idle && c < DISTRHO_PLUGIN_NUM_INPUTS; ++c ) {
+        for ( uint32_t i = 0; i < frames; ++i ) {
+            if ( inputs[ c ][ i ] != 0.f ) {
+                idle = false;
+                break;
+            }
+        }
+    }
+
+    if ( !idle ) {
+        silentFrames = 0;
+        suspended    = false;
+        return false;
+    }
+
+    if ( !suspended )
+    {
+        // suspend once the silence processed so far spans the tail, settings sustaining the
+        // output never suspend. The processor is reset so it resumes from the same state as
+        // a processor that has processed the silence, see RegraderProcess::advance()
+
+        int tail = regraderProcess->getTailLength( SILENCE_THRESHOLD );
+
+        if ( tail < 0 || silentFrames < ( uint64_t ) tail ) {
+            silentFrames += frames;
+            return false;
+        }
+
+        regraderProcess->reset();
+        suspended = true;
+    }
+    return true;
+}
+
+void PluginRegrader::updateDspLoad(double seconds, uint32_t frames)
+{
+    if ( frames == 0 )
+        return;
+
+    double sampleRate = getSampleRate();
+
+    loadTime   += seconds;
+    loadFrames += frames;
+    loadPeak    = std::max( loadPeak, ( float )( seconds * sampleRate / frames ));
+
+    if ( loadFrames < loadWindow )
+        return;
+
+    // publish the load of the elapsed window, clamped to the parameter range
+
+    model.setValue( kDspLoadId, std::min( 1.f, ( float )( loadTime * sampleRate / loadFrames )));
+    model.setValue( kDspLoadPeakId, std::min( 1.f, loadPeak ));
+
+    loadTime   = 0.0;
+    loadFrames = 0;
+    loadPeak   = 0.f;
 }
 
 // -----------------------------------------------------------------------
 
 void PluginRegrader::syncModel()
 {
-    regraderProcess->syncDelayToHost = Calc::toBool( fDelayHostSync );
-    regraderProcess->setDelayTime( fDelayTime );
-    regraderProcess->setDelayFeedback( fDelayFeedback );
-    regraderProcess->setDelayMix( fDelayMix );
-
-    regraderProcess->bitCrusherPostMix = Calc::toBool( fBitResolutionChain );
-    regraderProcess->decimatorPostMix  = Calc::toBool( fDecimatorChain );
-    regraderProcess->filterPostMix     = Calc::toBool( fFilterChain );
-    regraderProcess->flangerPostMix    = Calc::toBool( fFlangerChain );
-
-    regraderProcess->bitCrusher->setAmount( fBitResolution );
-    regraderProcess->bitCrusher->setLFO( fLFOBitResolution, fLFOBitResolutionDepth );
-    regraderProcess->decimator->setBits( ( int )( fDecimator * 32.f ));
-    regraderProcess->decimator->setRate( fLFODecimator );
-    regraderProcess->filter->updateProperties( fFilterCutoff, fFilterResonance, fLFOFilter, fLFOFilterDepth );
-
-    regraderProcess->flanger->setRate( fFlangerRate );
-    regraderProcess->flanger->setWidth( fFlangerWidth );
-    regraderProcess->flanger->setFeedback( fFlangerFeedback );
-    regraderProcess->flanger->setDelay( fFlangerDelay );
+    model.apply( regraderProcess );
+
+    // the lookahead of the limiter delays the output
+    setLatency( regraderProcess->getLatency() );
 }
 
 // -----------------------------------------------------------------------
@@ -26,6 +26,7 @@
 
 #include "DistrhoPlugin.hpp"
 #include "regraderprocess.h"
+#include "regradermodel.h"
 #include "global.h"
 
 namespace Igorski {
@@ -104,33 +105,27 @@ protected:
     // -------------------------------------------------------------------
 
 private:
-    float fDelayTime;
-    float fDelayHostSync;
-    float fDelayFeedback;
-    float fDelayMix;
-
-    float fBitResolution;
-    float fBitResolutionChain;
-    float fLFOBitResolution;
-    float fLFOBitResolutionDepth;
-
-    float fDecimator;
-    float fDecimatorChain;
-    float fLFODecimator;
-
-    float fFilterChain;
-    float fFilterCutoff;
-    float fFilterResonance;
-    float fLFOFilter;
-    float fLFOFilterDepth;
-
-    float fFlangerChain;
-    float fFlangerRate;
-    float fFlangerWidth;
-    float fFlangerFeedback;
-    float fFlangerDelay;
-
-    float outputGain; // for visualizing output gain in DAW
+    RegraderModel model; // normalized values of all parameters
+
+    // fraction of the real-time budget spent in run(), averaged and peak-held
+    // over windows of 1 / LOAD_WINDOW_RATE seconds (about a UI frame)
+
+    static constexpr double LOAD_WINDOW_RATE = 30.0;
+
+    double loadTime;     // seconds spent in run() during the current window
+    uint32_t loadFrames; // frames processed during the current window
+    uint32_t loadWindow; // frames in a window
+    float loadPeak;      // highest load of a single run() during the current window
+
+    // while the transport is stopped and the input is silent, processing is suspended
+    // once the output has decayed below SILENCE_THRESHOLD (-96 dB)
+
+    static constexpr float SILENCE_THRESHOLD = 1.58489e-5f;
+
+    bool transportKnown;    // whether expectedFrame is known (e.g. false before the first run())
+    uint64_t expectedFrame; // transport position at which the next run() continues without a jump
+    uint64_t silentFrames;  // frames of silent input processed while the transport is stopped
+    bool suspended;         // whether processing is suspended
 
     Igorski::RegraderProcess* regraderProcess;
 
@@ -138,6 +133,15 @@ private:
 
     void syncModel();
 
+    // accumulate the time spent processing given amount of frames into the DSP load
+
+    void updateDspLoad(double seconds, uint32_t frames);
+
+    // follows the host transport, resetting the processor when its position jumps (if
+    // enabled), and returns whether processing is suspended for given input
+
+    bool updateTransport(const TimePosition& timePos, const float** inputs, uint32_t frames);
+
     // -------------------------------------------------------------------
 
     struct ParameterRangesSimple
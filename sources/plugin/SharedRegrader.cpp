@@ -24,6 +24,10 @@
 #include "SharedRegrader.hpp"
 #include "global.h"
 #include "paramids.h"
+#include "paramdefaults.h"
+#include "filter.h"
+#include "wavetables.h"
+#include <cmath>
 
 namespace Igorski {
 namespace SharedRegrader {
@@ -37,35 +41,30 @@ void InitParameter(uint32_t index, Parameter& parameter)
     case kDelayTimeId:             // delay time
         parameter.symbol = "DelayTime";
         parameter.name = "Delay time";
-        parameter.ranges.def = 0.125;
         parameter.unit = "s";
         break;
     case kDelayHostSyncId:         // delay host sync
         parameter.symbol = "DelayHostSync";
         parameter.name = "Delay host sync";
-        parameter.ranges.def = 1.0;
         parameter.hints |= kParameterIsBoolean|kParameterIsInteger;
         break;
     case kDelayFeedbackId:         // delay feedback
         parameter.symbol = "DelayFeedback";
         parameter.name = "Delay feedback";
-        parameter.ranges.def = 0.2;
         break;
     case kDelayMixId:              // delay mix
         parameter.symbol = "DelayMix";
         parameter.name = "Delay mix";
-        parameter.ranges.def = 0.5;
         break;
 
     case kBitResolutionId:         // bit resolution
         parameter.symbol = "BitResolution";
         parameter.name = "Bit resolution";
-        parameter.ranges = ParameterRanges(16.0, 1.0, 16.0);
+        parameter.ranges = ParameterRanges(1.0, 1.0, 16.0);
         break;
     case kBitResolutionChainId:    // bit resolution pre/post delay mix
         parameter.symbol = "BitResolutionChain";
         parameter.name = "BitCrusher chain";
-        parameter.ranges.def = 1.0;
         parameter.hints |= kParameterIsBoolean|kParameterIsInteger;
         break;
     case kLFOBitResolutionId:      // bit resolution LFO rate
@@ -78,13 +77,12 @@ void InitParameter(uint32_t index, Parameter& parameter)
     case kLFOBitResolutionDepthId: // depth for bit resolution LFO
         parameter.symbol = "LFOBitResolutionDepth";
         parameter.name = "Bit LFO depth";
-        parameter.ranges.def = 0.75;
         break;
 
     case kDecimatorId:             // decimator
         parameter.symbol = "Decimator";
         parameter.name = "Decimator resolution";
-        parameter.ranges = ParameterRanges(32.0, 0.0, 32.0);
+        parameter.ranges = ParameterRanges(0.0, 0.0, 32.0);
         parameter.hints |= kParameterIsInteger;
         break;
     case kDecimatorChainId:        // decimator pre/post delay mix
@@ -105,13 +103,13 @@ void InitParameter(uint32_t index, Parameter& parameter)
     case kFilterCutoffId:          // filter cutoff
         parameter.symbol = "FilterCutoff";
         parameter.name = "Filter cutoff";
-        parameter.ranges = ParameterRanges(0.5 * Igorski::VST::FILTER_MAX_FREQ, Igorski::VST::FILTER_MIN_FREQ, Igorski::VST::FILTER_MAX_FREQ);
+        parameter.ranges = ParameterRanges(Igorski::VST::FILTER_MIN_FREQ, Igorski::VST::FILTER_MIN_FREQ, Igorski::VST::FILTER_MAX_FREQ);
         parameter.unit = "Hz";
         break;
     case kFilterResonanceId:       // filter resonance
         parameter.symbol = "FilterResonance";
         parameter.name = "Filter resonance";
-        parameter.ranges = ParameterRanges(Igorski::VST::FILTER_MAX_RESONANCE, Igorski::VST::FILTER_MIN_RESONANCE, Igorski::VST::FILTER_MAX_RESONANCE);
+        parameter.ranges = ParameterRanges(Igorski::VST::FILTER_MIN_RESONANCE, Igorski::VST::FILTER_MIN_RESONANCE, Igorski::VST::FILTER_MAX_RESONANCE);
         parameter.unit = "dB";
         break;
     case kLFOFilterId:             // filter LFO rate
@@ -124,7 +122,6 @@ void InitParameter(uint32_t index, Parameter& parameter)
     case kLFOFilterDepthId:        // depth for filter LFO
         parameter.symbol = "LFOFilterDepth";
         parameter.name = "Filter LFO depth";
-        parameter.ranges.def = 0.5;
         break;
 
     case kFlangerChainId:          // flanger pre/post delay mix
@@ -160,9 +157,131 @@ void InitParameter(uint32_t index, Parameter& parameter)
         parameter.hints |= kParameterIsOutput;
         break;
 
+    case kBitResolutionLoopId:     // bit resolution in delay feedback loop
+        parameter.symbol = "BitResolutionLoop";
+        parameter.name = "BitCrusher in loop";
+        parameter.hints |= kParameterIsBoolean|kParameterIsInteger;
+        break;
+    case kDecimatorLoopId:         // decimator in delay feedback loop
+        parameter.symbol = "DecimatorLoop";
+        parameter.name = "Decimator in loop";
+        parameter.hints |= kParameterIsBoolean|kParameterIsInteger;
+        break;
+    case kFilterLoopId:            // filter in delay feedback loop
+        parameter.symbol = "FilterLoop";
+        parameter.name = "Filter in loop";
+        parameter.hints |= kParameterIsBoolean|kParameterIsInteger;
+        break;
+
+    case kDspLoadId:               // for the average DSP load return to host
+        parameter.symbol = "DspLoad";
+        parameter.name = "DSP load";
+        parameter.ranges = ParameterRanges(0.0, 0.0, 100.0);
+        parameter.unit = "%";
+        parameter.hints |= kParameterIsOutput;
+        break;
+    case kDspLoadPeakId:           // for the peak DSP load return to host
+        parameter.symbol = "DspLoadPeak";
+        parameter.name = "DSP load peak";
+        parameter.ranges = ParameterRanges(0.0, 0.0, 100.0);
+        parameter.unit = "%";
+        parameter.hints |= kParameterIsOutput;
+        break;
+
+    case kLimiterLookaheadId:      // limiter lookahead (0 = no lookahead)
+        parameter.symbol = "LimiterLookahead";
+        parameter.name = "Limiter lookahead";
+        parameter.ranges = ParameterRanges(0.0, 0.0, 5.0);
+        parameter.unit = "ms";
+        break;
+    case kLimiterCeilingId:        // limiter true peak ceiling in lookahead mode
+        parameter.symbol = "LimiterCeiling";
+        parameter.name = "Limiter ceiling";
+        parameter.ranges = ParameterRanges(-12.0, -12.0, 0.0);
+        parameter.unit = "dBTP";
+        break;
+
+    case kFilterTypeId: {          // filter type
+        parameter.symbol = "FilterType";
+        parameter.name = "Filter type";
+        parameter.ranges = ParameterRanges(0.0, 0.0, Igorski::Filter::kNumTypes - 1);
+        parameter.hints |= kParameterIsInteger;
+
+        static const char* const labels[Igorski::Filter::kNumTypes] = {
+            "Classic low pass", "Low pass", "High pass", "Band pass",
+        };
+        ParameterEnumerationValue* values = new ParameterEnumerationValue[Igorski::Filter::kNumTypes];
+        for (int i = 0; i < Igorski::Filter::kNumTypes; ++i) {
+            values[i].label = labels[i];
+            values[i].value = i;
+        }
+        parameter.enumValues.count = Igorski::Filter::kNumTypes;
+        parameter.enumValues.restrictedMode = true;
+        parameter.enumValues.values = values;
+        break;
+    }
+    case kFilterSlopeId: {         // filter slope
+        parameter.symbol = "FilterSlope";
+        parameter.name = "Filter slope";
+        parameter.ranges = ParameterRanges(0.0, 0.0, Igorski::Filter::kNumSlopes - 1);
+        parameter.hints |= kParameterIsInteger;
+
+        static const char* const labels[Igorski::Filter::kNumSlopes] = {
+            "12 dB/oct", "24 dB/oct", "48 dB/oct",
+        };
+        ParameterEnumerationValue* values = new ParameterEnumerationValue[Igorski::Filter::kNumSlopes];
+        for (int i = 0; i < Igorski::Filter::kNumSlopes; ++i) {
+            values[i].label = labels[i];
+            values[i].value = i;
+        }
+        parameter.enumValues.count = Igorski::Filter::kNumSlopes;
+        parameter.enumValues.restrictedMode = true;
+        parameter.enumValues.values = values;
+        break;
+    }
+
+    case kLFOBitResolutionShapeId: // bit resolution LFO shape
+    case kLFOFilterShapeId: {      // filter LFO shape
+        if (index == kLFOBitResolutionShapeId) {
+            parameter.symbol = "LFOBitResolutionShape";
+            parameter.name = "Bit LFO shape";
+        }
+        else {
+            parameter.symbol = "LFOFilterShape";
+            parameter.name = "Filter LFO shape";
+        }
+        parameter.ranges = ParameterRanges(0.0, 0.0, Igorski::WaveTables::kNumShapes - 1);
+        parameter.hints |= kParameterIsInteger;
+
+        static const char* const labels[Igorski::WaveTables::kNumShapes] = {
+            "Sine", "Triangle", "Saw", "Square", "Sample and hold",
+        };
+        ParameterEnumerationValue* values = new ParameterEnumerationValue[Igorski::WaveTables::kNumShapes];
+        for (int i = 0; i < Igorski::WaveTables::kNumShapes; ++i) {
+            values[i].label = labels[i];
+            values[i].value = i;
+        }
+        parameter.enumValues.count = Igorski::WaveTables::kNumShapes;
+        parameter.enumValues.restrictedMode = true;
+        parameter.enumValues.values = values;
+        break;
+    }
+
+    case kTransportResetId:        // reset the effect when the host transport jumps
+        parameter.symbol = "TransportReset";
+        parameter.name = "Reset on seek";
+        parameter.hints |= kParameterIsBoolean|kParameterIsInteger;
+        break;
+
     default:
         DISTRHO_SAFE_ASSERT_RETURN(false, );
     }
+
+    // the defaults are shared with the RegraderModel, scaled onto the range of the parameter
+    double def = parameter.ranges.min + Igorski::ParamDefaults::getValue(index) * (double)(parameter.ranges.max - parameter.ranges.min);
+    if ((parameter.hints & kParameterIsInteger) != 0)
+        def = std::round(def);
+    parameter.ranges.def = (float)def;
 }
 
 }
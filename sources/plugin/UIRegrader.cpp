@@ -28,6 +28,8 @@
 #include "ui/BitmapCache.h"
 #include "ui/Slider.h"
 #include "ui/CheckBox.h"
+#include "ui/Meter.h"
+#include "ui/CairoExtra.h"
 
 // jpc: original LFO frequency control formula was: (((10.**x)-1.)*1.05556)+0.05
 
@@ -55,17 +57,20 @@ UIRegrader::UIRegrader()
     createSlider(kDelayFeedbackId, 155, 135, 134, 21);
     createSlider(kDelayMixId, 155, 159, 134, 21);
     createCheckBox(kDelayHostSyncId, 154, 182, 21, 21);
+    createCheckBox(kTransportResetId, 268, 182, 21, 21);
 
     // BitCrusher module
     createSlider(kBitResolutionId, 463, 111, 134, 21/*, kControlInverted*/);
     createSlider(kLFOBitResolutionId, 463, 135, 134, 21/*, kControlLogarithmic*/);
     createSlider(kLFOBitResolutionDepthId, 463, 159, 134, 21);
     createCheckBox(kBitResolutionChainId, 462, 182, 21, 21);
+    createCheckBox(kBitResolutionLoopId, 576, 182, 21, 21);
 
     // Decimator module
     createSlider(kDecimatorId, 771, 111, 134, 21);
     createSlider(kLFODecimatorId, 771, 135, 134, 21);
     createCheckBox(kDecimatorChainId, 770, 158, 21, 21);
+    createCheckBox(kDecimatorLoopId, 884, 158, 21, 21);
 
     // Filter module
     createSlider(kFilterCutoffId, 155, 311, 134, 21);
@@ -73,6 +78,9 @@ UIRegrader::UIRegrader()
     createSlider(kLFOFilterId, 155, 359, 134, 21/*, kControlLogarithmic*/);
     createSlider(kLFOFilterDepthId, 155, 383, 134, 21);
     createCheckBox(kFilterChainId, 154, 406, 21, 21);
+    createCheckBox(kFilterLoopId, 268, 406, 21, 21);
+    createSlider(kFilterTypeId, 163, 264, 50, 21);
+    createSlider(kFilterSlopeId, 264, 264, 33, 21);
 
     // Flanger module
     createSlider(kFlangerRateId, 463, 311, 134, 21, kControlLogarithmic);
@@ -81,6 +89,21 @@ UIRegrader::UIRegrader()
     createSlider(kFlangerDelayId, 463, 383, 134, 21);
     createCheckBox(kFlangerChainId, 462, 406, 21, 21);
 
+    // Limiter, below the modules
+    createSlider(kLimiterLookaheadId, 155, 440, 134, 21);
+    createSlider(kLimiterCeilingId, 463, 440, 134, 21);
+
+    // the LFO shapes are left to the generic controls of the host, the artwork
+    // has no row left for them in the modules and the header of the filter
+    // module is taken by its type and slope
+
+    // DSP load, the meter displays the average load with the peak load as a marker
+    fDspLoadMeter = new Meter(0x000000ff, 0x09f447ff, 0xffffffff, this);
+    fSubwidgets.push_back(fDspLoadMeter);
+    fDspLoadMeter->setValueBounds(fParameterRanges[kDspLoadId].min, fParameterRanges[kDspLoadId].max);
+    fDspLoadMeter->setAbsolutePos(771, 440);
+    fDspLoadMeter->setSize(134, 21);
+
     for (unsigned i = 0; i < kNumParameters; ++i) {
         ParameterRangesSimple range = fParameterRanges[i];
         setParameterValue(i, range.def);
@@ -115,6 +138,11 @@ void UIRegrader::parameterChanged(uint32_t index, float value) {
     if (CheckBox *ctl = fCheckBoxById[index]) {
         ctl->setValue(value, CControl::kDoNotNotify);
     }
+
+    if (index == kDspLoadId)
+        fDspLoadMeter->setValue(value, CControl::kDoNotNotify);
+    else if (index == kDspLoadPeakId)
+        fDspLoadMeter->setPeak(value);
 }
 
 /**
@@ -128,6 +156,14 @@ void UIRegrader::sampleRateChanged(double newSampleRate) {
 // Widget callbacks
 
 
+static void drawLabel(cairo_t *cr, const char *text, int right, int baseline)
+{
+    cairo_text_extents_t extents;
+    cairo_text_extents(cr, text, &extents);
+    cairo_move_to(cr, right - extents.x_advance - 6, baseline);
+    cairo_show_text(cr, text);
+}
+
 /**
   A function called to draw the view contents.
 */
@@ -140,6 +176,23 @@ void UIRegrader::onDisplay() {
     cairo_surface_t *bg = BitmapCache::load(150);
     cairo_set_source_surface(cr, bg, 0, 0);
     cairo_paint(cr);
+
+    // labels of the controls which are not part of the original artwork
+    cairo_select_font_face(cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr, 13.0);
+    cairo_set_source_rgba32(cr, 0x09f447ff);
+    drawLabel(cr, "SEEK RESET", 264, 197);
+    drawLabel(cr, "IN LOOP", 572, 197);
+    drawLabel(cr, "IN LOOP", 880, 173);
+    drawLabel(cr, "IN LOOP", 264, 421);
+    drawLabel(cr, "LOOKAHEAD", 151, 455);
+    drawLabel(cr, "CEILING", 459, 455);
+    drawLabel(cr, "DSP LOAD", 767, 455);
+
+    // labels inside the module headers
+    cairo_set_source_rgba32(cr, 0x000000ff);
+    drawLabel(cr, "TYPE", 159, 279);
+    drawLabel(cr, "SLOPE", 264, 279);
 }
 
 
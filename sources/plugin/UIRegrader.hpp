@@ -32,6 +32,7 @@
 
 class Slider;
 class CheckBox;
+class Meter;
 
 namespace Igorski {
 
@@ -63,6 +64,7 @@ private:
 private:
     Slider **fSliderById;
     CheckBox **fCheckBoxById;
+    Meter *fDspLoadMeter;
 
     std::list<Widget *> fSubwidgets;
 
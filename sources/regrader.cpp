@@ -0,0 +1,204 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "regrader.h"
+#include "regradermodel.h"
+#include "regraderprocess.h"
+#include "paramids.h"
+#include <algorithm>
+#include <new>
+
+using namespace Igorski;
+
+struct regrader
+{
+    RegraderProcess* process;
+    RegraderModel model;
+    int channels;
+    int maxBlockSize;
+};
+
+// the interleaved frames are deinterleaved using an array of channel pointers on the stack
+
+static_assert( REGRADER_MAX_CHANNELS <= SampleConvert::MAX_INTERLEAVED_CHANNELS, "too many channels" );
+
+regrader* regrader_create( int channels, double sampleRate, int maxBlockSize )
+{
+    if ( channels < 1 || channels > REGRADER_MAX_CHANNELS || !( sampleRate > 0.0 ) || maxBlockSize < 1 )
+        return 0;
+
+    regrader* instance = new ( std::nothrow ) regrader;
+    if ( instance == 0 )
+        return 0;
+
+    instance->process = 0;
+
+    // allocate the processor and its mix buffers up front, so processing does not allocate
+
+    try {
+        instance->process = new RegraderProcess( channels, ( float ) sampleRate );
+        instance->process->setMaxBufferSize( maxBlockSize );
+    }
+    catch ( ... ) {
+        delete instance->process;
+        delete instance;
+        return 0;
+    }
+
+    instance->channels     = channels;
+    instance->maxBlockSize = maxBlockSize;
+    instance->model.apply( instance->process );
+
+    return instance;
+}
+
+void regrader_destroy( regrader* instance )
+{
+    if ( instance == 0 )
+        return;
+
+    delete instance->process;
+    delete instance;
+}
+
+int regrader_get_parameter_count( void )
+{
+    return kNumParameters;
+}
+
+float regrader_get_parameter( const regrader* instance, int id )
+{
+    return ( instance != 0 ) ? instance->model.getValue( id ) : 0.f;
+}
+
+int regrader_set_parameter( regrader* instance, int id, float value )
+{
+    if ( instance == 0 )
+        return REGRADER_INVALID_ARGUMENT;
+
+    if ( id < 0 || id >= kNumParameters || RegraderModel::isOutput( id ))
+        return REGRADER_INVALID_PARAMETER;
+
+    instance->model.setValue( id, std::max( 0.f, std::min( 1.f, value )));
+    instance->model.apply( instance->process );
+
+    return REGRADER_OK;
+}
+
+int regrader_set_tempo( regrader* instance, double tempo, int timeSigNumerator, int timeSigDenominator )
+{
+    if ( instance == 0 || !( tempo > 0.0 ) || timeSigNumerator < 1 || timeSigDenominator < 1 )
+        return REGRADER_INVALID_ARGUMENT;
+
+    instance->process->setTempo( tempo, timeSigNumerator, timeSigDenominator );
+
+    return REGRADER_OK;
+}
+
+int regrader_set_control_interval( regrader* instance, int frames )
+{
+    if ( instance == 0 || frames < 1 )
+        return REGRADER_INVALID_ARGUMENT;
+
+    instance->process->setControlInterval( frames );
+
+    return REGRADER_OK;
+}
+
+int regrader_get_latency( const regrader* instance )
+{
+    return ( instance != 0 ) ? instance->process->getLatency() : 0;
+}
+
+int regrader_reset( regrader* instance )
+{
+    if ( instance == 0 )
+        return REGRADER_INVALID_ARGUMENT;
+
+    instance->process->reset();
+
+    return REGRADER_OK;
+}
+
+int regrader_process( regrader* instance, const float* const* inputs, float* const* outputs, int frames )
+{
+    if ( instance == 0 || inputs == 0 || outputs == 0 || frames < 0 )
+        return REGRADER_INVALID_ARGUMENT;
+
+    int channels = instance->channels;
+    float* in [ REGRADER_MAX_CHANNELS ];
+    float* out[ REGRADER_MAX_CHANNELS ];
+
+    // the processor does not write into its input, which is only declared non-const
+
+    for ( int offset = 0; offset < frames; offset += instance->maxBlockSize ) {
+        int length = std::min( instance->maxBlockSize, frames - offset );
+
+        for ( int c = 0; c < channels; ++c ) {
+            in [ c ] = const_cast<float*>( inputs[ c ] ) + offset;
+            out[ c ] = outputs[ c ] + offset;
+        }
+        instance->process->process<float>( in, out, channels, channels, length );
+    }
+    instance->model.setValue( kVuPPMId, instance->process->limiter->getLinearGR() );
+
+    return REGRADER_OK;
+}
+
+int regrader_process_interleaved( regrader* instance, const float* input, float* output, int frames )
+{
+    if ( instance == 0 || input == 0 || output == 0 || frames < 0 )
+        return REGRADER_INVALID_ARGUMENT;
+
+    int channels = instance->channels;
+
+    for ( int offset = 0; offset < frames; offset += instance->maxBlockSize ) {
+        int length = std::min( instance->maxBlockSize, frames - offset );
+
+        instance->process->process<float>(
+            input + ( size_t ) offset * channels, output + ( size_t ) offset * channels, channels, length
+        );
+    }
+    instance->model.setValue( kVuPPMId, instance->process->limiter->getLinearGR() );
+
+    return REGRADER_OK;
+}
+
+int regrader_process_batch( const regrader_block* blocks, int count )
+{
+    if ( blocks == 0 || count < 0 )
+        return REGRADER_INVALID_ARGUMENT;
+
+    int result = REGRADER_OK;
+
+    for ( int i = 0; i < count; ++i ) {
+        const regrader_block& block = blocks[ i ];
+
+        int blockResult = ( block.inputs != 0 )
+            ? regrader_process( block.instance, block.inputs, block.outputs, block.frames )
+            : regrader_process_interleaved( block.instance, block.interleavedInput, block.interleavedOutput, block.frames );
+
+        if ( result == REGRADER_OK )
+            result = blockResult;
+    }
+    return result;
+}
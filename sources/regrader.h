@@ -0,0 +1,132 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __REGRADER_H_INCLUDED__
+#define __REGRADER_H_INCLUDED__
+
+/**
+ * C interface for embedding the Regrader effect without a plugin host, it is
+ * part of the DSP library (see dsp/Makefile)
+ *
+ * an instance is created for a fixed amount of channels, sample rate and
+ * maximum block size. All memory is allocated upon creation, the functions
+ * below other than regrader_create and regrader_destroy do not allocate and
+ * can be called from the audio thread. An instance must not be used by more
+ * than one thread at a time
+ *
+ * parameters are identified by the ids in paramids.h and take normalized
+ * values in the 0 - 1 range, exactly as the plugin reports them to its host
+ *
+ * the functions returning int return REGRADER_OK on success or one of the
+ * negative error codes below
+ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined( __GNUC__ )
+#   define REGRADER_API __attribute__(( visibility( "default" )))
+#else
+#   define REGRADER_API
+#endif
+
+#define REGRADER_OK                 0
+#define REGRADER_INVALID_ARGUMENT  -1 // a null pointer, or a count out of range
+#define REGRADER_INVALID_PARAMETER -2 // an unknown parameter id, or one of an output parameter
+
+// the maximum amount of channels of an instance
+
+#define REGRADER_MAX_CHANNELS 8
+
+typedef struct regrader regrader;
+
+// a block to process by regrader_process_batch. When inputs is not null, the block is
+// processed as by regrader_process, otherwise as by regrader_process_interleaved
+
+typedef struct regrader_block
+{
+    regrader* instance;
+    int frames;
+
+    const float* const* inputs; // planar buffers, one per channel
+    float* const* outputs;
+
+    const float* interleavedInput; // interleaved frames
+    float* interleavedOutput;
+} regrader_block;
+
+// creates an instance, returns null when given properties are out of range or the
+// memory could not be allocated
+
+REGRADER_API regrader* regrader_create( int channels, double sampleRate, int maxBlockSize );
+
+REGRADER_API void regrader_destroy( regrader* instance );
+
+// the amount of parameter ids (see paramids.h)
+
+REGRADER_API int regrader_get_parameter_count( void );
+
+// the normalized value of given parameter, output parameters (e.g. kVuPPMId) report
+// the state of the last processed block. Unknown ids return 0
+
+REGRADER_API float regrader_get_parameter( const regrader* instance, int id );
+
+REGRADER_API int regrader_set_parameter( regrader* instance, int id, float value );
+
+// the tempo (in BPM) and time signature the delay time is synced to when host sync is enabled
+
+REGRADER_API int regrader_set_tempo( regrader* instance, double tempo, int timeSigNumerator, int timeSigDenominator );
+
+// the amount of frames in between reading the oscillators modulating the effects, 1 (the
+// default) reads them for every frame while larger intervals save processing time
+
+REGRADER_API int regrader_set_control_interval( regrader* instance, int frames );
+
+// the delay of the output relative to the input in frames, which depends on the
+// lookahead of the limiter (kLimiterLookaheadId). Returns 0 for a null instance
+
+REGRADER_API int regrader_get_latency( const regrader* instance );
+
+// clears the delay memory and the effects state, retaining the parameters
+
+REGRADER_API int regrader_reset( regrader* instance );
+
+// processes given amount of frames from a buffer per channel into a buffer per channel,
+// blocks longer than the maximum block size are processed in several parts. The output
+// buffers can be the same as the input buffers
+
+REGRADER_API int regrader_process( regrader* instance, const float* const* inputs, float* const* outputs, int frames );
+
+// as above for a buffer of interleaved frames
+
+REGRADER_API int regrader_process_interleaved( regrader* instance, const float* input, float* output, int frames );
+
+// processes a block for each of given amount of instances in turn. Returns the error
+// of the first block that could not be processed, the remaining blocks are processed
+
+REGRADER_API int regrader_process_batch( const regrader_block* blocks, int count );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __REGRADERBANK__H_INCLUDED__
+#define __REGRADERBANK__H_INCLUDED__
+
+#include "global.h"
+#include "audiobuffer.h"
+#include "limiter.h"
+#include <vector>
+
+/**
+ * a RegraderBank processes several independent instances of the Regrader
+ * effect at once, one per lane. The state of all lanes is kept in arrays
+ * indexed by lane (structure-of-arrays), each processing step loops over
+ * the lanes so the compiler can advance them together using SIMD instructions
+ *
+ * every lane has its own delay, bit crusher, decimator and filter settings
+ * and state. The bank covers the effect chain without oscillators, flanger
+ * or in loop placement, instances using these should use a RegraderProcess
+ */
+namespace Igorski {
+template <int LANES>
+class RegraderBank {
+
+    // max delay time in milliseconds, delay time is not synced to a host
+
+    const float MAX_DELAY_TIME_MS = 5000.f;
+
+    public:
+        RegraderBank( int amountOfChannels, float sampleRate );
+        ~RegraderBank();
+
+        // apply effect to the incoming buffers of each lane, buffers are
+        // provided as inBuffer[ lane ][ channel ]. Unused lanes can be NULL
+
+        template <typename SampleType>
+        void process( SampleType*** inBuffer, SampleType*** outBuffer, int bufferSize );
+
+        // setters use the same value ranges as their RegraderProcess, BitCrusher,
+        // Decimator and Filter counterparts, for the lane with given index
+
+        void setDelayTime( int lane, float value );
+        void setDelayFeedback( int lane, float value );
+        void setDelayMix( int lane, float value );
+
+        void setBitCrusherAmount( int lane, float value );
+        void setDecimatorBits( int lane, int value );
+        void setDecimatorRate( int lane, float value );
+        void setFilter( int lane, float cutoffPercentage, float resonancePercentage );
+
+        // whether effects are applied onto the input delay signal or onto
+        // the delayed signal itself (false = on input, true = on delay)
+
+        bool bitCrusherPostMix[ LANES ];
+        bool decimatorPostMix[ LANES ];
+        bool filterPostMix[ LANES ];
+
+    private:
+        int _amountOfChannels;
+        float _sampleRate;
+
+        // delay memory, the samples of all lanes are interleaved
+
+        AudioBuffer* _delayBuffer;
+        int _maxDelayTime;
+
+        int   _delayTime[ LANES ];
+        float _delayMix[ LANES ];
+        float _delayFeedback[ LANES ];
+        int*  _delayIndices; // per channel and lane
+
+        // bit crusher
+
+        int16 _crusherMask[ LANES ];
+        bool  _crusherBypass[ LANES ];
+
+        // decimator
+
+        int   _decimatorBits[ LANES ];
+        float _decimatorM[ LANES ];
+        float _decimatorRate[ LANES ];
+        float _decimatorAccumulator[ LANES ];
+        float _decimatorAccumulatorStored[ LANES ];
+
+        // filter
+
+        float _filterA1[ LANES ];
+        float _filterA2[ LANES ];
+        float _filterB1[ LANES ];
+        float _filterB2[ LANES ];
+        float* _filterState; // in1, in2, out1, out2 per channel and lane
+
+        // limiter
+
+        Limiter _limiter;
+        float _limiterGain[ LANES ];
+
+        // pre and post mix buffers, holding the samples of all lanes interleaved
+
+        std::vector<float> _preMixBuffer;
+        std::vector<float> _postMixBuffer;
+
+        // the effects are applied onto the lanes for which active is true
+
+        void crush( float* buffer, int bufferSize, const bool* active );
+        void decimate( float* buffer, int bufferSize, const bool* active );
+        void filter( float* buffer, int bufferSize, int c, const bool* active );
+        void delay( float* preMixBuffer, float* postMixBuffer, int bufferSize, int c );
+};
+
+typedef RegraderBank<4> RegraderBank4;
+typedef RegraderBank<8> RegraderBank8;
+}
+
+#include "regraderbank.tcc"
+
+#endif
@@ -0,0 +1,460 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "calc.h"
+#include <limits.h>
+#include <math.h>
+
+namespace Igorski
+{
+template <int LANES>
+RegraderBank<LANES>::RegraderBank( int amountOfChannels, float sampleRate )
+    : _limiter( 10.f, 500.f, .6f )
+{
+    _amountOfChannels = amountOfChannels;
+    _sampleRate       = sampleRate;
+
+    // the delay memory is lazily committed, see RegraderProcess
+
+    _maxDelayTime = Calc::millisecondsToBuffer( MAX_DELAY_TIME_MS, sampleRate );
+    _delayBuffer  = new AudioBuffer( amountOfChannels, _maxDelayTime * LANES, true );
+    _delayIndices = new int[ amountOfChannels * LANES ];
+    _filterState  = new float[ amountOfChannels * 4 * LANES ];
+
+    for ( int i = 0; i < amountOfChannels * LANES; ++i )
+        _delayIndices[ i ] = 0;
+
+    for ( int i = 0; i < amountOfChannels * 4 * LANES; ++i )
+        _filterState[ i ] = 0.f;
+
+    // lanes start out with the same defaults as a RegraderProcess
+
+    for ( int l = 0; l < LANES; ++l )
+    {
+        _delayTime[ l ]     = 0;
+        _delayMix[ l ]      = .5f;
+        _delayFeedback[ l ] = .1f;
+
+        _decimatorAccumulator[ l ] = 0.f;
+        _limiterGain[ l ]          = 1.f;
+
+        bitCrusherPostMix[ l ] = false;
+        decimatorPostMix[ l ]  = false;
+        filterPostMix[ l ]     = true;
+
+        setBitCrusherAmount( l, 1.f );
+        setDecimatorBits( l, 32 );
+        setDecimatorRate( l, 0.f );
+        setFilter( l, (( VST::FILTER_MAX_FREQ / 2 ) - VST::FILTER_MIN_FREQ ) / ( VST::FILTER_MAX_FREQ - VST::FILTER_MIN_FREQ ), 0.f );
+    }
+}
+
+template <int LANES>
+RegraderBank<LANES>::~RegraderBank()
+{
+    delete _delayBuffer;
+    delete[] _delayIndices;
+    delete[] _filterState;
+}
+
+/* setters */
+
+template <int LANES>
+void RegraderBank<LANES>::setDelayTime( int lane, float value )
+{
+    _delayTime[ lane ] = Calc::millisecondsToBuffer( Calc::cap( value ) * MAX_DELAY_TIME_MS, _sampleRate );
+
+    for ( int c = 0; c < _amountOfChannels; ++c ) {
+        if ( _delayIndices[ c * LANES + lane ] >= _delayTime[ lane ] )
+            _delayIndices[ c * LANES + lane ] = 0;
+    }
+}
+
+template <int LANES>
+void RegraderBank<LANES>::setDelayFeedback( int lane, float value )
+{
+    _delayFeedback[ lane ] = value;
+}
+
+template <int LANES>
+void RegraderBank<LANES>::setDelayMix( int lane, float value )
+{
+    _delayMix[ lane ] = value;
+}
+
+template <int LANES>
+void RegraderBank<LANES>::setBitCrusherAmount( int lane, float value )
+{
+    // scale float to 1 - 16 bit range, see BitCrusher
+    int bits = ( int ) floor( Calc::scale( value, 1, 15 )) + 1;
+
+    _crusherMask[ lane ]   = ( int16 )( ~0u << ( 16 - bits ));
+    _crusherBypass[ lane ] = ( bits == 16 );
+}
+
+template <int LANES>
+void RegraderBank<LANES>::setDecimatorBits( int lane, int value )
+{
+    // cap in 1 - 32 range, see Decimator
+    _decimatorBits[ lane ] = std::min( 32, std::max( 1, value ));
+    _decimatorM[ lane ]    = ( float )( 1LL << ( _decimatorBits[ lane ] - 1 ));
+}
+
+template <int LANES>
+void RegraderBank<LANES>::setDecimatorRate( int lane, float value )
+{
+    _decimatorRate[ lane ] = Calc::cap( value );
+}
+
+template <int LANES>
+void RegraderBank<LANES>::setFilter( int lane, float cutoffPercentage, float resonancePercentage )
+{
+    float cutoff    = VST::FILTER_MIN_FREQ + ( cutoffPercentage * ( VST::FILTER_MAX_FREQ - VST::FILTER_MIN_FREQ ));
+    float resonance = VST::FILTER_MIN_RESONANCE + ( resonancePercentage * ( VST::FILTER_MAX_RESONANCE - VST::FILTER_MIN_RESONANCE ));
+
+    cutoff    = std::max( VST::FILTER_MIN_FREQ, std::min( cutoff, VST::FILTER_MAX_FREQ ));
+    resonance = std::max( VST::FILTER_MIN_RESONANCE, std::min( resonance, VST::FILTER_MAX_RESONANCE ));
+
+    // see Filter::calculateParameters()
+
+    float c  = 1.f / tan( VST::PI * cutoff / _sampleRate );
+    float a1 = 1.f / ( 1.f + resonance * c + c * c );
+
+    _filterA1[ lane ] = a1;
+    _filterA2[ lane ] = 2.f * a1;
+    _filterB1[ lane ] = 2.f * ( 1.f - c * c ) * a1;
+    _filterB2[ lane ] = ( 1.f - resonance * c + c * c ) * a1;
+}
+
+/* process */
+
+template <int LANES>
+template <typename SampleType>
+void RegraderBank<LANES>::process( SampleType*** inBuffer, SampleType*** outBuffer, int bufferSize )
+{
+    int channelSize = bufferSize * LANES;
+    int i, l;
+
+    // the mix buffers are pooled, they only get reallocated when the buffer size changes
+
+    if (( int ) _preMixBuffer.size() != channelSize * _amountOfChannels ) {
+        _preMixBuffer.resize( channelSize * _amountOfChannels );
+        _postMixBuffer.resize( channelSize * _amountOfChannels );
+    }
+
+    // determine which effects are processed for which lane
+
+    bool preCrush[ LANES ], postCrush[ LANES ], preDecimate[ LANES ], postDecimate[ LANES ];
+    bool preFilter[ LANES ], postFilter[ LANES ];
+
+    for ( l = 0; l < LANES; ++l )
+    {
+        preCrush[ l ]     = !bitCrusherPostMix[ l ] && !_crusherBypass[ l ];
+        postCrush[ l ]    = bitCrusherPostMix[ l ] && !_crusherBypass[ l ];
+        preDecimate[ l ]  = !decimatorPostMix[ l ];
+        postDecimate[ l ] = decimatorPostMix[ l ];
+        preFilter[ l ]    = !filterPostMix[ l ];
+        postFilter[ l ]   = filterPostMix[ l ];
+    }
+
+    for ( int c = 0; c < _amountOfChannels; ++c )
+    {
+        float* channelPreMixBuffer  = &_preMixBuffer[ c * channelSize ];
+        float* channelPostMixBuffer = &_postMixBuffer[ c * channelSize ];
+
+        // interleave the lanes into the pre mix buffer
+
+        for ( l = 0; l < LANES; ++l )
+        {
+            SampleType* channelInBuffer = inBuffer[ l ] ? inBuffer[ l ][ c ] : 0;
+
+            for ( i = 0; i < bufferSize; ++i )
+                channelPreMixBuffer[ i * LANES + l ] = channelInBuffer ? ( float ) channelInBuffer[ i ] : 0.f;
+        }
+
+        // each channel is processed using the same decimator properties
+
+        if ( c == 0 ) {
+            for ( l = 0; l < LANES; ++l )
+                _decimatorAccumulatorStored[ l ] = _decimatorAccumulator[ l ];
+        }
+        else {
+            for ( l = 0; l < LANES; ++l )
+                _decimatorAccumulator[ l ] = _decimatorAccumulatorStored[ l ];
+        }
+
+        // PRE MIX processing
+
+        crush( channelPreMixBuffer, bufferSize, preCrush );
+        decimate( channelPreMixBuffer, bufferSize, preDecimate );
+        filter( channelPreMixBuffer, bufferSize, c, preFilter );
+
+        // DELAY processing
+
+        delay( channelPreMixBuffer, channelPostMixBuffer, bufferSize, c );
+
+        // POST MIX processing
+
+        decimate( channelPostMixBuffer, bufferSize, postDecimate );
+        crush( channelPostMixBuffer, bufferSize, postCrush );
+        filter( channelPostMixBuffer, bufferSize, c, postFilter );
+
+        // mix the input and processed post mix buffers
+
+        for ( l = 0; l < LANES; ++l )
+        {
+            if ( !inBuffer[ l ] )
+                continue;
+
+            SampleType* channelInBuffer = inBuffer[ l ][ c ];
+            SampleType wetMix = _delayMix[ l ];
+            SampleType dryMix = 1.f - _delayMix[ l ];
+
+            for ( i = 0; i < bufferSize; ++i ) {
+                SampleType sample = ( SampleType ) channelPostMixBuffer[ i * LANES + l ] * wetMix;
+                sample += channelInBuffer[ i ] * dryMix;
+                channelPostMixBuffer[ i * LANES + l ] = ( float ) sample;
+            }
+        }
+    }
+
+    // limit the output signal of each lane, see Limiter (hard knee)
+
+    float th = _limiter.getThresholdCoefficient();
+    float at = _limiter.getAttackCoefficient();
+    float re = _limiter.getReleaseCoefficient();
+    float tr = _limiter.getTrimCoefficient();
+
+    float* leftBuffer  = &_postMixBuffer[ 0 ];
+    float* rightBuffer = ( _amountOfChannels > 1 ) ? &_postMixBuffer[ channelSize ] : &_preMixBuffer[ 0 ];
+    float gain[ LANES ];
+
+    // a mono signal is limited against a silent right channel
+
+    if ( _amountOfChannels == 1 )
+        memset( rightBuffer, 0, channelSize * sizeof( float ));
+
+    for ( l = 0; l < LANES; ++l )
+        gain[ l ] = _limiterGain[ l ];
+
+    for ( i = 0; i < bufferSize; ++i )
+    {
+        float* left  = leftBuffer  + i * LANES;
+        float* right = rightBuffer + i * LANES;
+
+        for ( l = 0; l < LANES; ++l )
+        {
+            float ol  = left[ l ];
+            float or_ = right[ l ];
+            float g   = gain[ l ];
+            float lev = 0.5f * g * fabs( ol + or_ );
+
+            g = ( lev > th ) ? g - ( at * ( lev - th )) : g + ( re * ( 1.f - g ));
+
+            gain [ l ] = g;
+            left [ l ] = ol * tr * g;
+            right[ l ] = or_ * tr * g;
+        }
+    }
+
+    for ( l = 0; l < LANES; ++l )
+        _limiterGain[ l ] = gain[ l ];
+
+    // deinterleave the lanes into the output buffers
+
+    for ( int c = 0; c < _amountOfChannels; ++c )
+    {
+        float* channelPostMixBuffer = &_postMixBuffer[ c * channelSize ];
+
+        for ( l = 0; l < LANES; ++l )
+        {
+            if ( !outBuffer[ l ] )
+                continue;
+
+            SampleType* channelOutBuffer = outBuffer[ l ][ c ];
+
+            for ( i = 0; i < bufferSize; ++i )
+                channelOutBuffer[ i ] = ( SampleType ) channelPostMixBuffer[ i * LANES + l ];
+        }
+    }
+}
+
+/* private methods */
+
+// the lane properties and state are copied into local arrays as the compiler
+// can then tell they are not aliased by the buffer, which is required for
+// vectorizing the loops over the lanes
+
+template <int LANES>
+void RegraderBank<LANES>::crush( float* buffer, int bufferSize, const bool* active )
+{
+    int32 mask[ LANES ], enabled[ LANES ];
+
+    for ( int l = 0; l < LANES; ++l ) {
+        mask[ l ]    = _crusherMask[ l ];
+        enabled[ l ] = active[ l ];
+    }
+
+    for ( int i = 0; i < bufferSize; ++i )
+    {
+        float* samples = buffer + i * LANES;
+
+        for ( int l = 0; l < LANES; ++l )
+        {
+            // see BitCrusher::process()
+            int32 input   = ( short ) (( samples[ l ] * .5f ) * SHRT_MAX );
+            input         = ( short )( input & mask[ l ] );
+            float crushed = (( input - 1 ) * .5f ) / SHRT_MAX;
+
+            samples[ l ] = enabled[ l ] ? crushed : samples[ l ];
+        }
+    }
+}
+
+template <int LANES>
+void RegraderBank<LANES>::decimate( float* buffer, int bufferSize, const bool* active )
+{
+    float m[ LANES ], rate[ LANES ], accumulator[ LANES ];
+    int32 enabled[ LANES ], quantize[ LANES ];
+
+    for ( int l = 0; l < LANES; ++l ) {
+        m[ l ]           = _decimatorM[ l ];
+        rate[ l ]        = active[ l ] ? _decimatorRate[ l ] : 0.f;
+        accumulator[ l ] = _decimatorAccumulator[ l ];
+        enabled[ l ]     = active[ l ];
+        quantize[ l ]    = active[ l ] && _decimatorBits[ l ] < 32;
+    }
+
+    for ( int i = 0; i < bufferSize; ++i )
+    {
+        float* samples = buffer + i * LANES;
+
+        for ( int l = 0; l < LANES; ++l )
+        {
+            // see Decimator::process()
+            float sum       = accumulator[ l ] + rate[ l ];
+            int32 trigger   = sum >= 1.f;
+            float sample    = samples[ l ];
+            float decimated = m[ l ] * floor( sample / m[ l ] + 0.5f );
+
+            accumulator[ l ] = trigger ? sum - 1.f : sum;
+            samples[ l ]     = ( trigger & quantize[ l ] ) ? decimated : sample;
+        }
+    }
+
+    for ( int l = 0; l < LANES; ++l ) {
+        if ( enabled[ l ] )
+            _decimatorAccumulator[ l ] = accumulator[ l ];
+    }
+}
+
+template <int LANES>
+void RegraderBank<LANES>::filter( float* buffer, int bufferSize, int c, const bool* active )
+{
+    float a1[ LANES ], a2[ LANES ], b1[ LANES ], b2[ LANES ];
+    float in1[ LANES ], in2[ LANES ], out1[ LANES ], out2[ LANES ];
+    int32 enabled[ LANES ];
+
+    float* state = _filterState + c * 4 * LANES;
+
+    for ( int l = 0; l < LANES; ++l ) {
+        a1[ l ]      = _filterA1[ l ];
+        a2[ l ]      = _filterA2[ l ];
+        b1[ l ]      = _filterB1[ l ];
+        b2[ l ]      = _filterB2[ l ];
+        in1[ l ]     = state[ l ];
+        in2[ l ]     = state[ LANES + l ];
+        out1[ l ]    = state[ 2 * LANES + l ];
+        out2[ l ]    = state[ 3 * LANES + l ];
+        enabled[ l ] = active[ l ];
+    }
+
+    for ( int i = 0; i < bufferSize; ++i )
+    {
+        float* samples = buffer + i * LANES;
+
+        for ( int l = 0; l < LANES; ++l )
+        {
+            // see Filter::process()
+            float input  = samples[ l ];
+            float output = a1[ l ] * input + a2[ l ] * in1[ l ] + a1[ l ] * in2[ l ] - b1[ l ] * out1[ l ] - b2[ l ] * out2[ l ];
+
+            in2 [ l ] = in1[ l ];
+            in1 [ l ] = input;
+            out2[ l ] = out1[ l ];
+            out1[ l ] = output;
+
+            samples[ l ] = enabled[ l ] ? output : input;
+        }
+    }
+
+    for ( int l = 0; l < LANES; ++l ) {
+        if ( enabled[ l ] ) {
+            state[ l ]             = in1[ l ];
+            state[ LANES + l ]     = in2[ l ];
+            state[ 2 * LANES + l ] = out1[ l ];
+            state[ 3 * LANES + l ] = out2[ l ];
+        }
+    }
+}
+
+template <int LANES>
+void RegraderBank<LANES>::delay( float* preMixBuffer, float* postMixBuffer, int bufferSize, int c )
+{
+    float* delayBuffer = _delayBuffer->getBufferForChannel( c );
+    int* delayIndices  = _delayIndices + c * LANES;
+    int delayTime[ LANES ];
+
+    for ( int l = 0; l < LANES; ++l )
+    {
+        delayTime[ l ] = std::max( 1, std::min( _delayTime[ l ], _maxDelayTime ));
+
+        if ( delayIndices[ l ] >= delayTime[ l ] )
+            delayIndices[ l ] = 0;
+    }
+
+    // the lanes read and write at different positions in the delay memory
+    // so this step gathers and scatters the samples, see RegraderProcess::process()
+
+    for ( int i = 0; i < bufferSize; ++i )
+    {
+        for ( int l = 0; l < LANES; ++l )
+        {
+            int delayIndex = delayIndices[ l ];
+            int readIndex  = delayIndex + 1;
+
+            if ( readIndex >= delayTime[ l ] )
+                readIndex = 0;
+
+            float delaySample = delayBuffer[ readIndex * LANES + l ];
+            delayBuffer[ delayIndex * LANES + l ] = preMixBuffer[ i * LANES + l ] + delaySample * _delayFeedback[ l ];
+            postMixBuffer[ i * LANES + l ] = delaySample;
+
+            if ( ++delayIndex >= delayTime[ l ] )
+                delayIndex = 0;
+
+            delayIndices[ l ] = delayIndex;
+        }
+    }
+}
+
+}
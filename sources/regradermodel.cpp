@@ -0,0 +1,108 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "regradermodel.h"
+#include "calc.h"
+#include "paramdefaults.h"
+
+namespace Igorski {
+
+RegraderModel::RegraderModel()
+{
+    for ( int i = 0; i < kNumParameters; ++i )
+        _values[ i ] = ParamDefaults::getValue( i );
+}
+
+float RegraderModel::getValue( int id ) const
+{
+    if ( id < 0 || id >= kNumParameters )
+        return 0.f;
+
+    return _values[ id ];
+}
+
+void RegraderModel::setValue( int id, float value )
+{
+    if ( id < 0 || id >= kNumParameters )
+        return;
+
+    _values[ id ] = value;
+}
+
+bool RegraderModel::isOutput( int id )
+{
+    return id == kVuPPMId || id == kDspLoadId || id == kDspLoadPeakId;
+}
+
+void RegraderModel::apply( RegraderProcess* process ) const
+{
+    process->syncDelayToHost = Calc::toBool( _values[ kDelayHostSyncId ]);
+    process->setDelayTime( _values[ kDelayTimeId ]);
+    process->setDelayFeedback( _values[ kDelayFeedbackId ]);
+    process->setDelayMix( _values[ kDelayMixId ]);
+
+    process->bitCrusherPostMix = Calc::toBool( _values[ kBitResolutionChainId ]);
+    process->decimatorPostMix  = Calc::toBool( _values[ kDecimatorChainId ]);
+    process->filterPostMix     = Calc::toBool( _values[ kFilterChainId ]);
+    process->flangerPostMix    = Calc::toBool( _values[ kFlangerChainId ]);
+
+    process->bitCrusherInLoop = Calc::toBool( _values[ kBitResolutionLoopId ]);
+    process->decimatorInLoop  = Calc::toBool( _values[ kDecimatorLoopId ]);
+    process->filterInLoop     = Calc::toBool( _values[ kFilterLoopId ]);
+
+    process->bitCrusher->setAmount( _values[ kBitResolutionId ]);
+    process->bitCrusher->setLFO( _values[ kLFOBitResolutionId ], _values[ kLFOBitResolutionDepthId ]);
+    process->bitCrusher->lfo->setShape(( int ) roundf( _values[ kLFOBitResolutionShapeId ] * ( WaveTables::kNumShapes - 1 )));
+    process->decimator->setBits( ( int )( _values[ kDecimatorId ] * 32.f ));
+    process->decimator->setRate( _values[ kLFODecimatorId ]);
+    process->filter->setType(( int ) roundf( _values[ kFilterTypeId ] * ( Filter::kNumTypes - 1 )));
+    process->filter->setSlope(( int ) roundf( _values[ kFilterSlopeId ] * ( Filter::kNumSlopes - 1 )));
+    process->filter->lfo->setShape(( int ) roundf( _values[ kLFOFilterShapeId ] * ( WaveTables::kNumShapes - 1 )));
+    process->filter->updateProperties(
+        _values[ kFilterCutoffId ], _values[ kFilterResonanceId ], _values[ kLFOFilterId ], _values[ kLFOFilterDepthId ]
+    );
+
+    process->flanger->setRate( _values[ kFlangerRateId ]);
+    process->flanger->setWidth( _values[ kFlangerWidthId ]);
+    process->flanger->setFeedback( _values[ kFlangerFeedbackId ]);
+    process->flanger->setDelay( _values[ kFlangerDelayId ]);
+
+    process->setLimiterLookahead( _values[ kLimiterLookaheadId ]);
+    process->limiter->setCeiling( _values[ kLimiterCeilingId ] * 12.f - 12.f );
+}
+
+bool RegraderModel::fitsBank() const
+{
+    // the limiter ceiling only applies with a lookahead
+
+    return !Calc::toBool( _values[ kDelayHostSyncId ]) &&
+           _values[ kLFOBitResolutionId ] == 0.f && _values[ kLFOFilterId ] == 0.f &&
+           _values[ kFlangerRateId ] == 0.f && _values[ kFlangerWidthId ] == 0.f &&
+           !Calc::toBool( _values[ kBitResolutionLoopId ]) &&
+           !Calc::toBool( _values[ kDecimatorLoopId ]) &&
+           !Calc::toBool( _values[ kFilterLoopId ]) &&
+           roundf( _values[ kFilterTypeId ] * ( Filter::kNumTypes - 1 )) == Filter::kClassicLowPass &&
+           roundf( _values[ kFilterSlopeId ] * ( Filter::kNumSlopes - 1 )) == Filter::kSlope12dB &&
+           _values[ kLimiterLookaheadId ] == 0.f;
+}
+
+}
@@ -0,0 +1,89 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __REGRADERMODEL_H_INCLUDED__
+#define __REGRADERMODEL_H_INCLUDED__
+
+#include "global.h"
+#include "calc.h"
+#include "paramids.h"
+#include "regraderbank.h"
+#include "regraderprocess.h"
+
+/**
+ * the RegraderModel holds the normalized (0 - 1 range) values of all
+ * parameters listed in paramids.h and maps them onto the properties of a
+ * RegraderProcess. It has no dependency on the plugin framework, which
+ * allows tools to drive the processor exactly as the plugin does
+ */
+namespace Igorski {
+class RegraderModel {
+
+    public:
+        RegraderModel();
+
+        float getValue( int id ) const;
+        void setValue( int id, float value );
+
+        // whether given parameter is reported by the processor rather than controlled by the user
+
+        static bool isOutput( int id );
+
+        // synchronize the properties of given processor with the parameter values
+
+        void apply( RegraderProcess* process ) const;
+
+        // whether the parameter values only use the effects a RegraderBank provides: a delay
+        // not synced to the host, no oscillators, flanger, in loop placement or lookahead
+        // and the 12 dB classic low pass filter
+
+        bool fitsBank() const;
+
+        // synchronize the properties of the lane with given index of a RegraderBank with the
+        // parameter values, these should fit the bank (see fitsBank())
+
+        template <int LANES>
+        void apply( RegraderBank<LANES>* bank, int lane ) const;
+
+    private:
+        float _values[ kNumParameters ];
+};
+
+template <int LANES>
+void RegraderModel::apply( RegraderBank<LANES>* bank, int lane ) const
+{
+    bank->setDelayTime( lane, _values[ kDelayTimeId ]);
+    bank->setDelayFeedback( lane, _values[ kDelayFeedbackId ]);
+    bank->setDelayMix( lane, _values[ kDelayMixId ]);
+
+    bank->bitCrusherPostMix[ lane ] = Calc::toBool( _values[ kBitResolutionChainId ]);
+    bank->decimatorPostMix[ lane ]  = Calc::toBool( _values[ kDecimatorChainId ]);
+    bank->filterPostMix[ lane ]     = Calc::toBool( _values[ kFilterChainId ]);
+
+    bank->setBitCrusherAmount( lane, _values[ kBitResolutionId ]);
+    bank->setDecimatorBits( lane, ( int )( _values[ kDecimatorId ] * 32.f ));
+    bank->setDecimatorRate( lane, _values[ kLFODecimatorId ]);
+    bank->setFilter( lane, _values[ kFilterCutoffId ], _values[ kFilterResonanceId ]);
+}
+}
+
+#endif
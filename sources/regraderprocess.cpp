@@ -22,6 +22,8 @@
  */
 #include "regraderprocess.h"
 #include "calc.h"
+#include "sampleconvert.h"
+#include <limits.h>
 #include <math.h>
 
 namespace Igorski {
@@ -33,8 +35,13 @@ RegraderProcess::RegraderProcess( int amountOfChannels, float sampleRate ) {
     _delayMix      = .5f;
     _delayFeedback = .1f;
 
-    _delayBuffer  = new AudioBuffer( amountOfChannels, Calc::millisecondsToBuffer( MAX_DELAY_TIME_MS, sampleRate ));
+    // the delay memory is lazily committed, only the portion covered by
+    // the longest delay time in use will be backed by physical memory
+
+    _delayBuffer  = new AudioBuffer( amountOfChannels, Calc::millisecondsToBuffer( MAX_DELAY_TIME_MS, sampleRate ), true );
     _delayIndices = new int[ amountOfChannels ];
+    _delayExtent   = 0;
+    _compactExtent = 0;
 
     for ( int i = 0; i < amountOfChannels; ++i ) {
         _delayIndices[ i ] = 0;
@@ -47,11 +54,25 @@ RegraderProcess::RegraderProcess( int amountOfChannels, float sampleRate ) {
     flanger    = new Flanger( amountOfChannels, sampleRate );
     limiter    = new Limiter( 10.f, 500.f, .6f );
 
+    _modulation = new ModulationBus();
+
+#ifdef REGRADER_PROFILE
+    profileRing = StageProfiler::Ring::create();
+#endif
+
+    limiter->prepareLookahead(
+        Calc::millisecondsToBuffer( MAX_LIMITER_LOOKAHEAD_MS, sampleRate ), amountOfChannels, sampleRate
+    );
+
     bitCrusherPostMix = false;
     decimatorPostMix  = false;
     filterPostMix     = true;
     flangerPostMix    = true;
 
+    bitCrusherInLoop = false;
+    decimatorInLoop  = false;
+    filterInLoop     = false;
+
     // these will be synced to host, see vst.cpp. here we default to 120 BPM in 4/4 time
     _tempo              = 120.0;
     _timeSigNumerator   = 4;
@@ -74,6 +95,11 @@ RegraderProcess::~RegraderProcess() {
     delete filter;
     delete flanger;
     delete limiter;
+    delete _modulation;
+
+#ifdef REGRADER_PROFILE
+    StageProfiler::Ring::destroy( profileRing );
+#endif
 }
 
 /* setters */
@@ -108,6 +134,26 @@ void RegraderProcess::setDelayFeedback( float value )
     _delayFeedback = value;
 }
 
+void RegraderProcess::setLimiterLookahead( float value )
+{
+    limiter->setLookahead(( int ) roundf( Calc::cap( value ) * MAX_LIMITER_LOOKAHEAD_MS * .001f * _sampleRate ));
+}
+
+void RegraderProcess::setControlInterval( int samples )
+{
+    _modulation->setControlInterval( samples );
+}
+
+int RegraderProcess::getControlInterval()
+{
+    return _modulation->getControlInterval();
+}
+
+int RegraderProcess::getLatency()
+{
+    return limiter->getLatency();
+}
+
 void RegraderProcess::setTempo( double tempo, int32 timeSigNumerator, int32 timeSigDenominator )
 {
     if ( _tempo == tempo && _timeSigNumerator == timeSigNumerator && _timeSigDenominator == timeSigDenominator )
@@ -132,8 +178,403 @@ void RegraderProcess::setTempo( double tempo, int32 timeSigNumerator, int32 time
     _tempo              = tempo;
 }
 
+void RegraderProcess::setMaxBufferSize( int bufferSize )
+{
+    allocateMixBuffers( _amountOfChannels, bufferSize );
+    _modulation->setMaxBufferSize( _amountOfChannels * bufferSize );
+}
+
+void RegraderProcess::reset()
+{
+    // only the part of the delay memory that has been used needs clearing
+    // zero bits read as silence for both the float and 16-bit integer storage
+
+    for ( int c = 0; c < _amountOfChannels; ++c ) {
+        memset( _delayBuffer->getBufferForChannel( c ), 0, _delayExtent * sizeof( float ));
+        _delayIndices[ c ] = 0;
+    }
+    _delayExtent   = 0;
+    _compactExtent = 0;
+
+    bitCrusher->reset();
+    decimator->reset();
+    filter->reset();
+    flanger->reset();
+    limiter->reset();
+    _modulation->reset();
+}
+
+void RegraderProcess::advance( int numInChannels, int bufferSize )
+{
+    int delayTime = std::max( 1, std::min( _delayTime, _delayBuffer->bufferSize ));
+
+    bool hasFlanger = this->hasFlanger();
+
+    _modulation->setMaxBufferSize( numInChannels * bufferSize );
+    renderModulation( numInChannels, bufferSize );
+
+    const float* bitCrusherModulation = _modulation->getControl( ModulationBus::kBitCrusherLFO );
+    const float* filterModulation     = _modulation->getControl( ModulationBus::kFilterLFO );
+
+    // the effects are stored and restored in between channels as in process()
+
+    for ( int c = 0; c < numInChannels; ++c )
+    {
+        int delayIndex = ( _delayIndices[ c ] >= delayTime ) ? 0 : _delayIndices[ c ];
+        _delayIndices[ c ] = ( int ) (( delayIndex + ( int64 ) bufferSize ) % delayTime );
+
+        if ( c == 0 ) {
+            decimator->store();
+            filter->store();
+            flanger->store();
+        }
+
+        bitCrusher->advance( bufferSize, bitCrusherModulation + c * bufferSize );
+        decimator->advance( bufferSize );
+        filter->advance( bufferSize, filterModulation );
+
+        if ( hasFlanger )
+            flanger->advanceDelay( bufferSize );
+
+        if ( c < ( numInChannels - 1 )) {
+            decimator->restore();
+            filter->restore();
+            flanger->restore();
+        }
+    }
+}
+
+int RegraderProcess::getTailLength( float threshold )
+{
+    // quantizing or resonating effects inside the feedback loop can sustain the repeats
+
+    if ( bitCrusherInLoop || decimatorInLoop || filterInLoop || _delayFeedback >= 1.f )
+        return -1;
+
+    int delayTime  = std::max( 1, std::min( _delayTime, _delayBuffer->bufferSize ));
+    double repeats = ( _delayFeedback > 0.f ) ? ceil( log( threshold ) / log( _delayFeedback )) : 0.0;
+
+    // the effects are applied in series, their tails add up after the last repeat
+
+    int flangerTail = hasFlanger() ? flanger->getTailLength( threshold ) : 0;
+    int limiterTail = limiter->getTailLength( threshold );
+
+    if ( flangerTail < 0 || limiterTail < 0 )
+        return -1;
+
+    double tail = ( repeats + 1.0 ) * delayTime + filter->getTailLength( threshold ) + flangerTail + limiterTail;
+
+    return ( tail > INT_MAX ) ? -1 : ( int ) tail;
+}
+
 /* protected methods */
 
+void RegraderProcess::allocateMixBuffers( int numChannels, int bufferSize )
+{
+    // if the mix buffers weren't created yet or are too small for the buffer size
+    // delete existing buffers and create new ones to match properties. Smaller
+    // buffers are processed using the start of the existing mix buffers
+
+    if ( _preMixBuffer == 0 || _preMixBuffer->bufferSize < bufferSize || _preMixBuffer->amountOfChannels < numChannels ) {
+        delete _preMixBuffer;
+        _preMixBuffer = new AudioBuffer( numChannels, bufferSize );
+    }
+
+    if ( _postMixBuffer == 0 || _postMixBuffer->bufferSize < bufferSize || _postMixBuffer->amountOfChannels < numChannels ) {
+        delete _postMixBuffer;
+        _postMixBuffer = new AudioBuffer( numChannels, bufferSize );
+    }
+
+    _modulation->setMaxBufferSize( numChannels * bufferSize );
+}
+
+void RegraderProcess::processMixBuffers( int numChannels, int bufferSize )
+{
+    int i, readIndex, delayIndex, chunkSize;
+
+    // the delay time can exceed the delay memory when synced to a slow host tempo
+
+    int delayTime = std::max( 1, std::min( _delayTime, _delayBuffer->bufferSize ));
+    _delayExtent  = std::max( _delayExtent, delayTime );
+
+    // switch the delay memory storage format when the effect chain has changed, a slice at a time
+
+    setCompactDelay( canCompactDelay() );
+
+    float compactScale   = 32767.f / COMPACT_DELAY_RANGE;
+    float compactUnscale = COMPACT_DELAY_RANGE / 32767.f;
+
+    // only apply flange if the flanger has a positive rate or width
+
+    bool hasFlanger = this->hasFlanger();
+
+    // the oscillators are rendered once for all channels and effect placements
+
+    renderModulation( numChannels, bufferSize );
+
+    const float* filterModulation = _modulation->getControl( ModulationBus::kFilterLFO );
+    const float* flangerSweep     = _modulation->getControl( ModulationBus::kFlangerSweep );
+
+    for ( int32 c = 0; c < numChannels; ++c )
+    {
+        float* channelPreMixBuffer  = _preMixBuffer->getBufferForChannel( c );
+        float* channelDelayBuffer   = _delayBuffer->getBufferForChannel( c );
+        float* channelPostMixBuffer = _postMixBuffer->getBufferForChannel( c );
+
+        const float* bitCrusherModulation = _modulation->getControl( ModulationBus::kBitCrusherLFO ) + c * bufferSize;
+
+        delayIndex = _delayIndices[ c ];
+
+        // when processing the first channel, store the current effects properties
+        // so each subsequent channel is processed using the same processor variables
+
+        if ( c == 0 ) {
+            decimator->store();
+            filter->store();
+            flanger->store();
+        }
+
+        // PRE MIX processing
+
+        if ( !bitCrusherPostMix && !bitCrusherInLoop ) {
+            REGRADER_PROFILE_STAGE( profileRing, kBitCrusherPreMix, c, bufferSize );
+            bitCrusher->process( channelPreMixBuffer, bufferSize, bitCrusherModulation );
+        }
+
+        if ( !decimatorPostMix && !decimatorInLoop ) {
+            REGRADER_PROFILE_STAGE( profileRing, kDecimatorPreMix, c, bufferSize );
+            decimator->process( channelPreMixBuffer, bufferSize );
+        }
+
+        if ( !filterPostMix && !filterInLoop ) {
+            REGRADER_PROFILE_STAGE( profileRing, kFilterPreMix, c, bufferSize );
+            filter->process( channelPreMixBuffer, bufferSize, c, filterModulation );
+        }
+
+        if ( hasFlanger && !flangerPostMix ) {
+            REGRADER_PROFILE_STAGE( profileRing, kFlangerPreMix, c, bufferSize );
+            flanger->process( channelPreMixBuffer, bufferSize, c, flangerSweep + c * bufferSize );
+        }
+
+        // DELAY processing applied onto the temp buffer
+        // the buffer is processed in chunks that end where either the read or the write
+        // pointer wraps around. As the read pointer always leads the write pointer, a chunk
+        // never reads back its own writes, which allows applying the in loop effects onto
+        // whole chunks of delayed samples (at most a delay time in length) instead of per sample
+
+        REGRADER_PROFILE_BEGIN( delayLoopStart );
+
+        if ( delayIndex >= delayTime )
+            delayIndex = 0;
+
+        for ( i = 0; i < bufferSize; i += chunkSize )
+        {
+            // the read index points to the oldest sample in the delay line
+
+            readIndex = delayIndex + 1;
+
+            if ( readIndex >= delayTime )
+                readIndex = 0;
+
+            chunkSize = std::min( bufferSize - i, delayTime - std::max( delayIndex, readIndex ));
+
+            // nor do the chunks cross the compact extent while the storage format is switching
+
+            if ( delayIndex < _compactExtent )
+                chunkSize = std::min( chunkSize, _compactExtent - delayIndex );
+
+            if ( readIndex < _compactExtent )
+                chunkSize = std::min( chunkSize, _compactExtent - readIndex );
+
+            float* chunkPreMixBuffer  = channelPreMixBuffer  + i;
+            float* chunkPostMixBuffer = channelPostMixBuffer + i;
+
+            // write the previously delayed samples into the post mix buffer
+
+            if ( readIndex < _compactExtent )
+                SampleConvert::int16ToFloat(
+                    ( int16* ) channelDelayBuffer + readIndex, chunkPostMixBuffer, chunkSize, compactUnscale
+                );
+            else
+                memcpy( chunkPostMixBuffer, channelDelayBuffer + readIndex, chunkSize * sizeof( float ));
+
+            // IN LOOP processing
+            // apply the effects onto the delayed samples before they are fed back into the delay line
+
+            if ( bitCrusherInLoop )
+                bitCrusher->process( chunkPostMixBuffer, chunkSize, bitCrusherModulation + i );
+
+            if ( decimatorInLoop )
+                decimator->process( chunkPostMixBuffer, chunkSize );
+
+            if ( filterInLoop )
+                filter->process( chunkPostMixBuffer, chunkSize, c, filterModulation + i );
+
+            // append the processed pre mix buffer samples to the delayed samples ( for feedback purposes )
+
+            if ( delayIndex < _compactExtent ) {
+                for ( int j = 0; j < chunkSize; ++j )
+                    chunkPreMixBuffer[ j ] += chunkPostMixBuffer[ j ] * _delayFeedback;
+
+                SampleConvert::floatToInt16(
+                    chunkPreMixBuffer, ( int16* ) channelDelayBuffer + delayIndex, chunkSize, compactScale
+                );
+            }
+            else {
+                float* chunkDelayBuffer = channelDelayBuffer + delayIndex;
+
+                for ( int j = 0; j < chunkSize; ++j )
+                    chunkDelayBuffer[ j ] = chunkPreMixBuffer[ j ] + chunkPostMixBuffer[ j ] * _delayFeedback;
+            }
+
+            delayIndex += chunkSize;
+
+            if ( delayIndex >= delayTime )
+                delayIndex = 0;
+        }
+
+        // update last delay index for this channel
+
+        _delayIndices[ c ] = delayIndex;
+
+        REGRADER_PROFILE_END( profileRing, delayLoopStart, kDelayLoop, c, bufferSize );
+
+        // POST MIX processing
+        // apply the post mix effect processing
+
+        if ( decimatorPostMix && !decimatorInLoop ) {
+            REGRADER_PROFILE_STAGE( profileRing, kDecimatorPostMix, c, bufferSize );
+            decimator->process( channelPostMixBuffer, bufferSize );
+        }
+
+        if ( bitCrusherPostMix && !bitCrusherInLoop ) {
+            REGRADER_PROFILE_STAGE( profileRing, kBitCrusherPostMix, c, bufferSize );
+            bitCrusher->process( channelPostMixBuffer, bufferSize, bitCrusherModulation );
+        }
+
+        if ( filterPostMix && !filterInLoop ) {
+            REGRADER_PROFILE_STAGE( profileRing, kFilterPostMix, c, bufferSize );
+            filter->process( channelPostMixBuffer, bufferSize, c, filterModulation );
+        }
+
+        if ( hasFlanger && flangerPostMix ) {
+            REGRADER_PROFILE_STAGE( profileRing, kFlangerPostMix, c, bufferSize );
+            flanger->process( channelPostMixBuffer, bufferSize, c, flangerSweep + c * bufferSize );
+        }
+
+        // prepare effects for the next channel
+
+        if ( c < ( numChannels - 1 )) {
+            decimator->restore();
+            filter->restore();
+            flanger->restore();
+        }
+    }
+}
+
+void RegraderProcess::renderModulation( int numChannels, int bufferSize )
+{
+    if ( bitCrusher->hasLFO )
+        _modulation->render( ModulationBus::kBitCrusherLFO, bitCrusher->lfo, numChannels * bufferSize );
+
+    if ( filter->hasLFO() )
+        _modulation->render( ModulationBus::kFilterLFO, filter->lfo, bufferSize );
+
+    // the flanger restores the position of its sweep for each channel but not its direction,
+    // so its sweep is rendered for each channel in turn from the same position
+
+    if ( hasFlanger() )
+    {
+        for ( int c = 0; c < numChannels; ++c )
+        {
+            if ( c == 0 ) {
+                _modulation->store( ModulationBus::kFlangerSweep );
+                flanger->sweep->store();
+            }
+            else {
+                _modulation->restore( ModulationBus::kFlangerSweep );
+                flanger->sweep->restore();
+            }
+            _modulation->render( ModulationBus::kFlangerSweep, flanger->sweep, bufferSize, c * bufferSize );
+        }
+    }
+}
+
+bool RegraderProcess::hasFlanger()
+{
+    return flanger->getRate() > 0.f || flanger->getWidth() > 0.f;
+}
+
+bool RegraderProcess::canCompactDelay()
+{
+    // the crusher must be the first effect to process the input signal
+    // any subsequent effect generates detail within its quantization noise
+
+    return !bitCrusherPostMix && !bitCrusherInLoop && bitCrusher->getMaxBits() <= COMPACT_DELAY_MAX_BITS;
+}
+
+void RegraderProcess::setCompactDelay( bool compact )
+{
+    // only the part of the delay memory that has been used needs converting,
+    // the remainder is still silent which reads the same in both formats
+
+    int target = compact ? _delayExtent : 0;
+
+    if ( _compactExtent == target )
+        return;
+
+    int from = _compactExtent;
+    int to   = compact ? std::min( target, from + COMPACT_DELAY_SLICE ) : std::max( target, from - COMPACT_DELAY_SLICE );
+
+    _compactExtent = to;
+
+    // the conversion is done in place in blocks using a temporary buffer, the integer
+    // samples occupy the lower half of the memory of the float samples. Converting to
+    // integers goes from the start of the slice and converting back from the end so
+    // the blocks that still need to be converted are never overwritten
+
+    const int blockSize = 256;
+    float floatBlock[ blockSize ];
+    int16 intBlock  [ blockSize ];
+
+    int start     = std::min( from, to );
+    int end       = std::max( from, to );
+    int numBlocks = ( end - start + blockSize - 1 ) / blockSize;
+
+    for ( int c = 0; c < _amountOfChannels; ++c )
+    {
+        char* memory = ( char* ) _delayBuffer->getBufferForChannel( c );
+
+        for ( int b = 0; b < numBlocks; ++b )
+        {
+            int length = std::min( blockSize, end - start - b * blockSize );
+            int offset = compact ? start + b * blockSize : end - b * blockSize - length;
+
+            if ( compact ) {
+                memcpy( floatBlock, memory + offset * sizeof( float ), length * sizeof( float ));
+                SampleConvert::floatToInt16( floatBlock, intBlock, length, 32767.f / COMPACT_DELAY_RANGE );
+                memcpy( memory + offset * sizeof( int16 ), intBlock, length * sizeof( int16 ));
+            }
+            else {
+                memcpy( intBlock, memory + offset * sizeof( int16 ), length * sizeof( int16 ));
+                SampleConvert::int16ToFloat( intBlock, floatBlock, length, COMPACT_DELAY_RANGE / 32767.f );
+                memcpy( memory + offset * sizeof( float ), floatBlock, length * sizeof( float ));
+            }
+        }
+
+        // the memory from the end of the integer samples up to the start of the float samples
+        // is kept silent, so integer samples beyond the compact extent read as silence when the
+        // delay extent grows and the compact extent can move either way. This silences the
+        // samples the conversion has left behind in it
+
+        size_t silenceStart = compact ? std::max( to * sizeof( int16 ), from * sizeof( float )) : to * sizeof( int16 );
+        size_t silenceEnd   = compact ? to * sizeof( float ) : std::min( from * sizeof( int16 ), to * sizeof( float ));
+
+        if ( silenceEnd > silenceStart )
+            memset( memory + silenceStart, 0, silenceEnd - silenceStart );
+    }
+}
+
 void RegraderProcess::syncDelayTime()
 {
     // duration of a full measure in samples
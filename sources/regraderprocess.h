@@ -23,6 +23,7 @@
 #ifndef __REGRADERPROCESS__H_INCLUDED__
 #define __REGRADERPROCESS__H_INCLUDED__
 
+#include <algorithm>
 #include "global.h"
 #include "audiobuffer.h"
 #include "bitcrusher.h"
@@ -30,6 +31,10 @@
 #include "filter.h"
 #include "flanger.h"
 #include "limiter.h"
+#include "modulationbus.h"
+#include "sampleconvert.h"
+#include "stageprofiler.h"
+#include "rtcheck.h"
 
 namespace Igorski {
 class RegraderProcess {
@@ -40,6 +45,24 @@ class RegraderProcess {
 
     const float MAX_DELAY_TIME_MS = 5000.f;
 
+    // max lookahead of the output limiter in milliseconds
+
+    const float MAX_LIMITER_LOOKAHEAD_MS = 5.f;
+
+    // when the pre mix BitCrusher limits the resolution of the delayed signal
+    // to this amount of bits (or less), the delay memory is stored as 16-bit
+    // integers instead of floats. This halves the memory the delay reads and
+    // writes, the reservation is unchanged and pages already committed for float
+    // samples stay committed, only the pages that are not touched yet are saved.
+    // The stored range spans +/- COMPACT_DELAY_RANGE to give the feedback some
+    // headroom, which makes the step of the storage (4 / 32767) that of a 13-bit
+    // crusher at its output mix of .5. Switching the storage converts at most
+    // COMPACT_DELAY_SLICE samples per channel per cycle
+
+    const int COMPACT_DELAY_MAX_BITS = 13;
+    const float COMPACT_DELAY_RANGE  = 4.f;
+    const int COMPACT_DELAY_SLICE    = 4096;
+
     public:
         RegraderProcess( int amountOfChannels, float sampleRate );
         ~RegraderProcess();
@@ -48,20 +71,68 @@ class RegraderProcess {
 
         template <typename SampleType>
         void process( SampleType** inBuffer, SampleType** outBuffer, int numInChannels, int numOutChannels,
-            int bufferSize, uint32 sampleFramesSize
+            int bufferSize
         );
 
+        // apply effect to interleaved frames of numChannels samples (at most
+        // SampleConvert::MAX_INTERLEAVED_CHANNELS, frames of more channels are passed
+        // through unprocessed), in and out buffers can be the same
+
+        template <typename SampleType>
+        void process( const SampleType* inBuffer, SampleType* outBuffer, int numChannels, int bufferSize );
+
         // set delay time (in milliseconds)
 
         void setDelayTime( float value );
         void setDelayFeedback( float value );
         void setDelayMix( float value );
 
+        // set the lookahead of the output limiter (0 - 1 range of its maximum lookahead), where
+        // 0 selects the original limiter without lookahead
+
+        void setLimiterLookahead( float value );
+
+        // the amount of samples in between reading the oscillators of the effects, where 1
+        // (the default) reads them for every sample. The effects hold the values read in
+        // between, so a larger interval saves recalculating their properties
+
+        void setControlInterval( int samples );
+        int getControlInterval();
+
+        // the delay of the output relative to the input, in samples
+
+        int getLatency();
+
         // synchronize the delays tempo with the host
         // tempo is in BPM, time signature provided as: timeSigNumerator / timeSigDenominator (e.g. 3/4)
 
         void setTempo( double tempo, int32 timeSigNumerator, int32 timeSigDenominator );
 
+        // creates the mix buffers and the control buffers of the modulation bus for processing
+        // buffers of up to given size, after which process() does not allocate for buffers of
+        // that size or smaller
+
+        void setMaxBufferSize( int bufferSize );
+
+        // clears the delay memory and the state of all effects so the next signal is
+        // processed as if by a newly constructed instance, without reallocating. The
+        // parameters (delay time, effect settings, etc.) are retained
+
+        void reset();
+
+        // moves the oscillators and delay positions along exactly as a process() call for the
+        // same amount of channels and buffer size would, without processing. After a reset()
+        // this recreates the state of a processor that has processed as many buffers of audio
+        // followed by enough silence for the delay memory and effects to decay
+
+        void advance( int numInChannels, int bufferSize );
+
+        // the amount of samples it takes for the output to decay below given (linear)
+        // threshold once the input is silent, or -1 when the current settings sustain
+        // the output indefinitely
+
+        int getTailLength( float threshold );
+
         BitCrusher* bitCrusher;
         Decimator* decimator;
         Filter* filter;
@@ -76,16 +147,33 @@ class RegraderProcess {
         bool filterPostMix;
         bool flangerPostMix;
 
+        // whether effects are applied inside the delays feedback loop, in which
+        // case each repeat is processed again (this takes precedence over the
+        // pre/post mix placement above)
+
+        bool bitCrusherInLoop;
+        bool decimatorInLoop;
+        bool filterInLoop;
+
         // whether delay time is synced to hosts tempo
 
         bool syncDelayToHost;
 
+#ifdef REGRADER_PROFILE
+        // timings of the processing stages, to be drained by a non real-time thread
+
+        StageProfiler::Ring* profileRing;
+#endif
+
     private:
         AudioBuffer* _delayBuffer;   // contains the delay memory
         AudioBuffer* _preMixBuffer;  // buffer used for the pre-delay effect mixing
         AudioBuffer* _postMixBuffer; // buffer used for the post-delay effect mixing
+        ModulationBus* _modulation;  // renders the oscillators of the effects once per buffer
 
         int* _delayIndices;
+        int _delayExtent;   // the amount of samples of the delay memory in use (e.g. the longest delay time so far)
+        int _compactExtent; // the samples of the delay memory below this index are 16-bit integers, the others floats
 
         int _delayTime; // delay time is represented internally in buffer samples
         float _delayMix;
@@ -98,13 +186,45 @@ class RegraderProcess {
 
         float _sampleRate;
 
-        // ensures the pre- and post mix buffers match the appropriate amount of channels
+        // ensures the pre- and post mix buffers fit the appropriate amount of channels
         // and buffer size. this also clones the contents of given in buffer into the pre-mix buffer
         // the buffers are pooled so this can be called upon each process cycle without allocation overhead
 
         template <typename SampleType>
         void prepareMixBuffers( SampleType** inBuffer, int numInChannels, int bufferSize );
 
+        // as above, deinterleaving the frames of given in buffer into the pre-mix buffer
+
+        template <typename SampleType>
+        void prepareMixBuffers( const SampleType* inBuffer, int numChannels, int bufferSize );
+
+        void allocateMixBuffers( int numChannels, int bufferSize );
+
+        // applies the effects and the delay onto the pre-mix buffer for given amount of channels,
+        // leaving the processed signal that is to be mixed with the input in the post mix buffer
+
+        void processMixBuffers( int numChannels, int bufferSize );
+
+        // renders the oscillators of the enabled effects onto the modulation bus for given amount
+        // of channels. The bit crusher oscillator and the flanger sweep are rendered for each channel
+        // in turn, as they have always moved along while processing each channel (the bit crusher is
+        // not restored between channels, the flanger does not restore the direction of its sweep)
+
+        void renderModulation( int numChannels, int bufferSize );
+
+        // whether the flanger is applied, which it is when it has a positive rate or width
+
+        bool hasFlanger();
+
+        // whether the current effect chain allows storing the delay memory as 16-bit integers
+
+        bool canCompactDelay();
+
+        // converts the next slice of the used delay memory in place between float and 16-bit
+        // integer storage, moving the compact extent towards the delay extent (or 0)
+
+        void setCompactDelay( bool compact );
+
         // syncs current delay time to musically pleasing intervals synced to host tempo and time signature
 
         void syncDelayTime();
@@ -24,141 +24,111 @@ namespace Igorski
 {
 template <typename SampleType>
 void RegraderProcess::process( SampleType** inBuffer, SampleType** outBuffer, int numInChannels, int numOutChannels,
-                               int bufferSize, uint32 sampleFramesSize ) {
+                               int bufferSize ) {
 
     // input and output buffers can be float or double as defined
     // by the templates SampleType value. Internally we process
     // audio as floats
 
-    SampleType inSample;
-    float delaySample;
-    int i, readIndex, delayIndex, channelDelayBufferChannel;
+    REGRADER_RT_SCOPE;
 
+    SampleType inSample;
     SampleType dryMix = 1.f - _delayMix;
-    int maxReadIndex  = std::min( _delayTime, _delayBuffer->bufferSize );
 
     // prepare the mix buffers and clone the incoming buffer contents into the pre-mix buffer
 
-    prepareMixBuffers( inBuffer, numInChannels, bufferSize );
+    {
+        REGRADER_PROFILE_STAGE( profileRing, kPrepareMixBuffers, -1, bufferSize );
+        prepareMixBuffers( inBuffer, numInChannels, bufferSize );
+    }
 
-    // only apply flange if the flanger has a positive rate or width
+    processMixBuffers( numInChannels, bufferSize );
 
-    bool hasFlanger = ( flanger->getRate() > 0.f || flanger->getWidth() > 0.f );
+    // mix the input and processed post mix buffers into the output buffer
 
     for ( int32 c = 0; c < numInChannels; ++c )
     {
         SampleType* channelInBuffer  = inBuffer[ c ];
         SampleType* channelOutBuffer = outBuffer[ c ];
-        float* channelPreMixBuffer   = _preMixBuffer->getBufferForChannel( c );
-        float* channelDelayBuffer    = _delayBuffer->getBufferForChannel( c );
         float* channelPostMixBuffer  = _postMixBuffer->getBufferForChannel( c );
 
-        delayIndex = _delayIndices[ c ];
-
-        // when processing the first channel, store the current effects properties
-        // so each subsequent channel is processed using the same processor variables
-
-        if ( c == 0 ) {
-            decimator->store();
-            filter->store();
-            flanger->store();
-        }
-
-        // PRE MIX processing
-
-        if ( !bitCrusherPostMix )
-            bitCrusher->process( channelPreMixBuffer, bufferSize );
-
-        if ( !decimatorPostMix )
-            decimator->process( channelPreMixBuffer, bufferSize );
-
-        if ( !filterPostMix )
-            filter->process( channelPreMixBuffer, bufferSize, c );
-
-        if ( hasFlanger && !flangerPostMix )
-            flanger->process( channelPreMixBuffer, bufferSize, c );
-
-        // DELAY processing applied onto the temp buffer
-
-        for ( i = 0; i < bufferSize; ++i )
-        {
-            readIndex = delayIndex - _delayTime + 1;
+        REGRADER_PROFILE_STAGE( profileRing, kMix, c, bufferSize );
 
-            if ( readIndex < 0 ) {
-                readIndex += _delayTime;
-            }
-
-            // read the previously delayed samples from the buffer
-            // ( for feedback purposes ) and append the processed pre mix buffer sample to it
+        for ( int i = 0; i < bufferSize; ++i ) {
 
-            delaySample = channelDelayBuffer[ readIndex ];
-            channelDelayBuffer[ delayIndex ] = channelPreMixBuffer[ i ] + delaySample * _delayFeedback;
+            // before writing to the out buffer we take a snapshot of the current in sample
+            // value as VST2 in Ableton Live supplies the same buffer for in and out!
+            inSample = channelInBuffer[ i ];
 
-            if ( ++delayIndex >= maxReadIndex ) {
-                delayIndex = 0;
-            }
+            // wet mix (e.g. the effected delay signal)
+            channelOutBuffer[ i ] = ( SampleType ) channelPostMixBuffer[ i ] * _delayMix;
 
-            // write the delay sample into the post mix buffer
-            channelPostMixBuffer[ i ] = delaySample;
+            // dry mix (e.g. mix in the input signal)
+            channelOutBuffer[ i ] += ( inSample * dryMix );
         }
+    }
 
-        // update last delay index for this channel
-
-        _delayIndices[ c ] = delayIndex;
+    // limit the output signal as it can get quite hot
+    {
+        REGRADER_PROFILE_STAGE( profileRing, kLimiter, -1, bufferSize );
+        limiter->process<SampleType>( outBuffer, bufferSize, numOutChannels );
+    }
+}
 
-        // POST MIX processing
-        // apply the post mix effect processing
+template <typename SampleType>
+void RegraderProcess::process( const SampleType* inBuffer, SampleType* outBuffer, int numChannels, int bufferSize ) {
 
-        if ( decimatorPostMix )
-            decimator->process( channelPostMixBuffer, bufferSize );
+    REGRADER_RT_SCOPE;
 
-        if ( bitCrusherPostMix )
-            bitCrusher->process( channelPostMixBuffer, bufferSize );
+    // the frames are deinterleaved through an array of channel pointers, frames of
+    // more channels than it holds are passed through unprocessed
 
-        if ( filterPostMix )
-            filter->process( channelPostMixBuffer, bufferSize, c );
+    if ( numChannels > SampleConvert::MAX_INTERLEAVED_CHANNELS ) {
+        if ( outBuffer != inBuffer )
+            std::copy( inBuffer, inBuffer + numChannels * bufferSize, outBuffer );
+        return;
+    }
 
-        if ( hasFlanger && flangerPostMix )
-            flanger->process( channelPostMixBuffer, bufferSize, c );
+    SampleType inSample;
+    SampleType dryMix = 1.f - _delayMix;
 
-        // mix the input and processed post mix buffers into the output buffer
+    // prepare the mix buffers, deinterleaving the incoming frames into the pre-mix buffer
 
-        for ( i = 0; i < bufferSize; ++i ) {
+    {
+        REGRADER_PROFILE_STAGE( profileRing, kPrepareMixBuffers, -1, bufferSize );
+        prepareMixBuffers( inBuffer, numChannels, bufferSize );
+    }
 
-            // before writing to the out buffer we take a snapshot of the current in sample
-            // value as VST2 in Ableton Live supplies the same buffer for in and out!
-            inSample = channelInBuffer[ i ];
+    processMixBuffers( numChannels, bufferSize );
 
-            // wet mix (e.g. the effected delay signal)
-            channelOutBuffer[ i ] = ( SampleType ) channelPostMixBuffer[ i ] * _delayMix;
+    // mix the input and processed post mix buffers straight into the interleaved output,
+    // the input sample is read before it is written as the buffers can be the same
 
-            // dry mix (e.g. mix in the input signal)
-            channelOutBuffer[ i ] += ( inSample * dryMix );
-        }
+    for ( int32 c = 0; c < numChannels; ++c )
+    {
+        const SampleType* channelInBuffer = inBuffer + c;
+        SampleType* channelOutBuffer      = outBuffer + c;
+        float* channelPostMixBuffer       = _postMixBuffer->getBufferForChannel( c );
 
-        // prepare effects for the next channel
+        REGRADER_PROFILE_STAGE( profileRing, kMix, c, bufferSize );
 
-        if ( c < ( numInChannels - 1 )) {
-            decimator->restore();
-            filter->restore();
-            flanger->restore();
+        for ( int i = 0; i < bufferSize; ++i ) {
+            inSample = channelInBuffer[ i * numChannels ];
+            channelOutBuffer[ i * numChannels ] = ( SampleType ) channelPostMixBuffer[ i ] * _delayMix + inSample * dryMix;
         }
     }
 
     // limit the output signal as it can get quite hot
-    limiter->process<SampleType>( outBuffer, bufferSize, numOutChannels );
+    {
+        REGRADER_PROFILE_STAGE( profileRing, kLimiter, -1, bufferSize );
+        limiter->processInterleaved<SampleType>( outBuffer, bufferSize, numChannels );
+    }
 }
 
 template <typename SampleType>
 void RegraderProcess::prepareMixBuffers( SampleType** inBuffer, int numInChannels, int bufferSize )
 {
-    // if the pre mix buffer wasn't created yet or the buffer size has changed
-    // delete existing buffer and create new one to match properties
-
-    if ( _preMixBuffer == 0 || _preMixBuffer->bufferSize != bufferSize ) {
-        delete _preMixBuffer;
-        _preMixBuffer = new AudioBuffer( numInChannels, bufferSize );
-    }
+    allocateMixBuffers( numInChannels, bufferSize );
 
     // clone the in buffer contents
     // note the clone is always cast to float as it is
@@ -172,13 +142,23 @@ void RegraderProcess::prepareMixBuffers( SampleType** inBuffer, int numInChannel
             outChannelBuffer[ i ] = ( float ) inChannelBuffer[ i ];
         }
     }
+}
+
+template <typename SampleType>
+void RegraderProcess::prepareMixBuffers( const SampleType* inBuffer, int numChannels, int bufferSize )
+{
+    allocateMixBuffers( numChannels, bufferSize );
+
+    // deinterleave the in buffer contents, cast to float
 
-    // if the post mix buffer wasn't created yet or the buffer size has changed
-    // delete existing buffer and create new one to match properties
+    float* outChannelBuffers[ SampleConvert::MAX_INTERLEAVED_CHANNELS ];
+    for ( int c = 0; c < numChannels; ++c )
+        outChannelBuffers[ c ] = _preMixBuffer->getBufferForChannel( c );
 
-    if ( _postMixBuffer == 0 || _postMixBuffer->bufferSize != bufferSize ) {
-        delete _postMixBuffer;
-        _postMixBuffer = new AudioBuffer( numInChannels, bufferSize );
+    for ( int i = 0; i < bufferSize; ++i ) {
+        for ( int c = 0; c < numChannels; ++c ) {
+            outChannelBuffers[ c ][ i ] = ( float ) inBuffer[ i * numChannels + c ];
+        }
     }
 }
 
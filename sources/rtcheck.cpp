@@ -0,0 +1,289 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "rtcheck.h"
+
+#ifdef REGRADER_RT_CHECK
+
+#include <atomic>
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined( __GLIBC__ )
+#   define REGRADER_RT_CHECK_INTERPOSE_C 1
+#   include <dlfcn.h>
+#   include <execinfo.h>
+#   include <pthread.h>
+#   include <unistd.h>
+#endif
+
+// the state is kept in static TLS, as dynamic TLS may allocate upon first access
+
+#if defined( __GNUC__ )
+#   define REGRADER_RT_TLS __thread __attribute__(( tls_model( "initial-exec" )))
+#else
+#   define REGRADER_RT_TLS thread_local
+#endif
+
+namespace Igorski {
+namespace RtCheck {
+
+    // maximum amount of violations printed, subsequent violations are only counted
+
+    static const unsigned long long MAX_REPORTS = 16;
+
+    static REGRADER_RT_TLS int depth     = 0; // amount of nested scopes of the thread
+    static REGRADER_RT_TLS int reporting = 0; // whether the thread is reporting a violation
+
+    static std::atomic<unsigned long long> violations( 0 );
+
+    Scope::Scope()
+    {
+        ++depth;
+    }
+
+    Scope::~Scope()
+    {
+        --depth;
+    }
+
+    bool isRealtime()
+    {
+        return depth > 0 && reporting == 0;
+    }
+
+    unsigned long long getViolationCount()
+    {
+        return violations.load();
+    }
+
+    static void writeString( const char* string )
+    {
+#ifdef REGRADER_RT_CHECK_INTERPOSE_C
+        ssize_t result = write( STDERR_FILENO, string, strlen( string ));
+        ( void ) result;
+#else
+        fputs( string, stderr );
+#endif
+    }
+
+    static void report( const char* function )
+    {
+        ++reporting;
+
+        unsigned long long count = ++violations;
+
+        if ( count <= MAX_REPORTS ) {
+            writeString( "RtCheck: " );
+            writeString( function );
+            writeString( " called on the audio thread\n" );
+#ifdef REGRADER_RT_CHECK_INTERPOSE_C
+            // the first frames are those of the checker itself
+            void* frames[ 32 ];
+            int numFrames = backtrace( frames, 32 );
+            backtrace_symbols_fd( frames + 2, numFrames - 2, STDERR_FILENO );
+#endif
+            if ( count == MAX_REPORTS )
+                writeString( "RtCheck: further violations are counted but not reported\n" );
+        }
+
+        if ( getenv( "REGRADER_RT_CHECK_ABORT" ))
+            abort();
+
+        --reporting;
+    }
+
+    static inline void check( const char* function )
+    {
+        if ( isRealtime())
+            report( function );
+    }
+
+    // prints the amount of violations when the program ends
+
+    static struct Summary
+    {
+        Summary()
+        {
+#ifdef REGRADER_RT_CHECK_INTERPOSE_C
+            // the first backtrace loads the unwinder, which allocates
+            void* frames[ 1 ];
+            backtrace( frames, 1 );
+#endif
+        }
+
+        ~Summary()
+        {
+            fprintf( stderr, "RtCheck: %llu violation(s) on the audio thread\n", getViolationCount());
+        }
+    } summary;
+}
+}
+
+using Igorski::RtCheck::check;
+
+#ifdef REGRADER_RT_CHECK_INTERPOSE_C
+extern "C" {
+void* __libc_malloc( size_t size );
+void* __libc_calloc( size_t count, size_t size );
+void* __libc_realloc( void* ptr, size_t size );
+void __libc_free( void* ptr );
+}
+#endif
+
+// the C++ operators allocate without passing through the interposed C functions,
+// which would report the same violation twice
+
+static inline void* allocate( std::size_t size )
+{
+#ifdef REGRADER_RT_CHECK_INTERPOSE_C
+    return __libc_malloc( size ? size : 1 );
+#else
+    return malloc( size ? size : 1 );
+#endif
+}
+
+static inline void deallocate( void* ptr )
+{
+#ifdef REGRADER_RT_CHECK_INTERPOSE_C
+    __libc_free( ptr );
+#else
+    free( ptr );
+#endif
+}
+
+// -----------------------------------------------------------------------
+// C++ allocation
+
+void* operator new( std::size_t size )
+{
+    check( "operator new" );
+    void* ptr = allocate( size );
+    if ( !ptr )
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[]( std::size_t size )
+{
+    check( "operator new[]" );
+    void* ptr = allocate( size );
+    if ( !ptr )
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new( std::size_t size, const std::nothrow_t& ) noexcept
+{
+    check( "operator new" );
+    return allocate( size );
+}
+
+void* operator new[]( std::size_t size, const std::nothrow_t& ) noexcept
+{
+    check( "operator new[]" );
+    return allocate( size );
+}
+
+void operator delete( void* ptr ) noexcept
+{
+    if ( ptr )
+        check( "operator delete" );
+    deallocate( ptr );
+}
+
+void operator delete[]( void* ptr ) noexcept
+{
+    if ( ptr )
+        check( "operator delete[]" );
+    deallocate( ptr );
+}
+
+void operator delete( void* ptr, std::size_t ) noexcept
+{
+    if ( ptr )
+        check( "operator delete" );
+    deallocate( ptr );
+}
+
+void operator delete[]( void* ptr, std::size_t ) noexcept
+{
+    if ( ptr )
+        check( "operator delete[]" );
+    deallocate( ptr );
+}
+
+// -----------------------------------------------------------------------
+// C allocation and locking, forwarded to the glibc implementations
+
+#ifdef REGRADER_RT_CHECK_INTERPOSE_C
+
+extern "C" {
+
+void* malloc( size_t size )
+{
+    check( "malloc" );
+    return __libc_malloc( size );
+}
+
+void* calloc( size_t count, size_t size )
+{
+    check( "calloc" );
+    return __libc_calloc( count, size );
+}
+
+void* realloc( void* ptr, size_t size )
+{
+    check( "realloc" );
+    return __libc_realloc( ptr, size );
+}
+
+void free( void* ptr )
+{
+    if ( ptr )
+        check( "free" );
+    __libc_free( ptr );
+}
+
+typedef int ( *MutexLockFunction )( pthread_mutex_t* );
+
+// not a function local static, as guarding its initialization may lock a mutex
+
+static MutexLockFunction realMutexLock = 0;
+
+int pthread_mutex_lock( pthread_mutex_t* mutex )
+{
+    check( "pthread_mutex_lock" );
+
+    if ( !realMutexLock )
+        realMutexLock = ( MutexLockFunction ) dlsym( RTLD_NEXT, "pthread_mutex_lock" );
+
+    return realMutexLock( mutex );
+}
+
+}
+
+#endif
+
+#endif
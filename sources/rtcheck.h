@@ -0,0 +1,76 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __RTCHECK_HEADER__
+#define __RTCHECK_HEADER__
+
+/**
+ * debug instrumentation verifying the audio thread does not allocate,
+ * free or lock. The checks are only compiled in when REGRADER_RT_CHECK is
+ * defined (e.g. make RT_CHECK=true), otherwise REGRADER_RT_SCOPE expands to nothing
+ *
+ * code running on the audio thread (e.g. PluginRegrader::run and
+ * RegraderProcess::process) is marked with REGRADER_RT_SCOPE. Any call to
+ * operator new/delete, malloc/calloc/realloc/free or pthread_mutex_lock made
+ * by a thread while inside such a scope is reported with a backtrace onto
+ * the standard error. The interposition of the C functions requires glibc
+ *
+ * when the REGRADER_RT_CHECK_ABORT environment variable is set, the process
+ * aborts on the first violation so it can be inspected in a debugger
+ */
+#ifdef REGRADER_RT_CHECK
+
+namespace Igorski {
+namespace RtCheck {
+
+    // marks the calling thread as running real-time code for the lifetime of the scope
+
+    class Scope
+    {
+        public:
+            Scope();
+            ~Scope();
+    };
+
+    // whether the calling thread is currently inside a Scope
+
+    bool isRealtime();
+
+    // amount of violations recorded since startup
+
+    unsigned long long getViolationCount();
+}
+}
+
+#define REGRADER_RT_CONCAT_( a, b ) a##b
+#define REGRADER_RT_CONCAT( a, b ) REGRADER_RT_CONCAT_( a, b )
+
+#define REGRADER_RT_SCOPE \
+    Igorski::RtCheck::Scope REGRADER_RT_CONCAT( __rtScope, __LINE__ )
+
+#else
+
+#define REGRADER_RT_SCOPE do {} while ( 0 )
+
+#endif
+
+#endif
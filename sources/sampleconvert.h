@@ -0,0 +1,255 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __SAMPLECONVERT_HEADER__
+#define __SAMPLECONVERT_HEADER__
+
+#include "global.h"
+
+/**
+ * conversion of sample buffers between the floating point format
+ * used for processing and the integer formats used for storage
+ *
+ * the loops are kept free of branches and function calls
+ * so the compiler can vectorize them
+ */
+namespace Igorski {
+namespace SampleConvert {
+
+    /**
+     * convert given amount of float samples into 16-bit integers, the samples
+     * are multiplied by scale, rounded and saturated into the 16-bit range
+     */
+    inline void floatToInt16( const float* in, int16* out, int length, float scale )
+    {
+        for ( int i = 0; i < length; ++i )
+        {
+            float value = in[ i ] * scale;
+            value = value < -32768.f ? -32768.f : value;
+            value = value >  32767.f ?  32767.f : value;
+            out[ i ] = ( int16 )( value + ( value < 0.f ? -.5f : .5f ));
+        }
+    }
+
+    /**
+     * convert given amount of 16-bit integer samples into floats,
+     * the samples are multiplied by scale
+     */
+    inline void int16ToFloat( const int16* in, float* out, int length, float scale )
+    {
+        for ( int i = 0; i < length; ++i )
+            out[ i ] = ( float ) in[ i ] * scale;
+    }
+
+    /**
+     * the following convert between the planar float samples used for processing
+     * and the interleaved little endian samples of audio files, in the full scale range
+     * of their format. The interleaved samples need not be aligned, they are accessed
+     * through memcpy which compiles into plain (unaligned) loads and stores. When inlined
+     * with a constant amount of channels the loops vectorize, the (de)interleaving
+     * turning into shuffles. Note the host is expected to be little endian
+     */
+    const int MAX_INTERLEAVED_CHANNELS = 8;
+
+    inline void int16LEToFloat( const uint8* in, int numChannels, float* const* outBuffers, int length )
+    {
+        float* out[ MAX_INTERLEAVED_CHANNELS ];
+        for ( int c = 0; c < numChannels; ++c )
+            out[ c ] = outBuffers[ c ];
+
+        for ( int i = 0; i < length; ++i )
+        {
+            for ( int c = 0; c < numChannels; ++c )
+            {
+                int16 value;
+                memcpy( &value, in + ( i * numChannels + c ) * sizeof( int16 ), sizeof( int16 ));
+                out[ c ][ i ] = ( float ) value * ( 1.f / 32768.f );
+            }
+        }
+    }
+
+    inline void int24LEToFloat( const uint8* in, int numChannels, float* const* outBuffers, int length )
+    {
+        float* out[ MAX_INTERLEAVED_CHANNELS ];
+        for ( int c = 0; c < numChannels; ++c )
+            out[ c ] = outBuffers[ c ];
+
+        for ( int i = 0; i < length; ++i )
+        {
+            for ( int c = 0; c < numChannels; ++c )
+            {
+                const uint8* sample = in + ( i * numChannels + c ) * 3;
+
+                // assemble the sample in the upper bytes, the shift back extends the sign
+                int32 value = ( int32 )(( uint32 ) sample[ 0 ] << 8 | ( uint32 ) sample[ 1 ] << 16 | ( uint32 ) sample[ 2 ] << 24 ) >> 8;
+                out[ c ][ i ] = ( float ) value * ( 1.f / 8388608.f );
+            }
+        }
+    }
+
+    inline void int32LEToFloat( const uint8* in, int numChannels, float* const* outBuffers, int length )
+    {
+        float* out[ MAX_INTERLEAVED_CHANNELS ];
+        for ( int c = 0; c < numChannels; ++c )
+            out[ c ] = outBuffers[ c ];
+
+        for ( int i = 0; i < length; ++i )
+        {
+            for ( int c = 0; c < numChannels; ++c )
+            {
+                int32 value;
+                memcpy( &value, in + ( i * numChannels + c ) * sizeof( int32 ), sizeof( int32 ));
+                out[ c ][ i ] = ( float ) value * ( 1.f / 2147483648.f );
+            }
+        }
+    }
+
+    inline void float32LEToFloat( const uint8* in, int numChannels, float* const* outBuffers, int length )
+    {
+        float* out[ MAX_INTERLEAVED_CHANNELS ];
+        for ( int c = 0; c < numChannels; ++c )
+            out[ c ] = outBuffers[ c ];
+
+        for ( int i = 0; i < length; ++i )
+        {
+            for ( int c = 0; c < numChannels; ++c )
+                memcpy( &out[ c ][ i ], in + ( i * numChannels + c ) * sizeof( float ), sizeof( float ));
+        }
+    }
+
+    inline void float64LEToFloat( const uint8* in, int numChannels, float* const* outBuffers, int length )
+    {
+        float* out[ MAX_INTERLEAVED_CHANNELS ];
+        for ( int c = 0; c < numChannels; ++c )
+            out[ c ] = outBuffers[ c ];
+
+        for ( int i = 0; i < length; ++i )
+        {
+            for ( int c = 0; c < numChannels; ++c )
+            {
+                double value;
+                memcpy( &value, in + ( i * numChannels + c ) * sizeof( double ), sizeof( double ));
+                out[ c ][ i ] = ( float ) value;
+            }
+        }
+    }
+
+    /**
+     * the conversions into integers round and saturate the samples into the range of
+     * the format, these comparisons only vectorize when they are known not to trap
+     * (e.g. when compiling with -fno-trapping-math, which -ffast-math implies)
+     */
+    inline void floatToInt16LE( const float* const* inBuffers, int numChannels, uint8* out, int length )
+    {
+        const float* in[ MAX_INTERLEAVED_CHANNELS ];
+        for ( int c = 0; c < numChannels; ++c )
+            in[ c ] = inBuffers[ c ];
+
+        for ( int i = 0; i < length; ++i )
+        {
+            for ( int c = 0; c < numChannels; ++c )
+            {
+                float value = in[ c ][ i ] * 32768.f;
+                value = value < -32768.f ? -32768.f : value;
+                value = value >  32767.f ?  32767.f : value;
+                int16 sample = ( int16 )( value + ( value < 0.f ? -.5f : .5f ));
+                memcpy( out + ( i * numChannels + c ) * sizeof( int16 ), &sample, sizeof( int16 ));
+            }
+        }
+    }
+
+    inline void floatToInt24LE( const float* const* inBuffers, int numChannels, uint8* out, int length )
+    {
+        const float* in[ MAX_INTERLEAVED_CHANNELS ];
+        for ( int c = 0; c < numChannels; ++c )
+            in[ c ] = inBuffers[ c ];
+
+        for ( int i = 0; i < length; ++i )
+        {
+            for ( int c = 0; c < numChannels; ++c )
+            {
+                float value = in[ c ][ i ] * 8388608.f;
+                value = value < -8388608.f ? -8388608.f : value;
+                value = value >  8388607.f ?  8388607.f : value;
+                int32 sample = ( int32 )( value + ( value < 0.f ? -.5f : .5f ));
+
+                uint8* bytes = out + ( i * numChannels + c ) * 3;
+                bytes[ 0 ] = ( uint8 ) sample;
+                bytes[ 1 ] = ( uint8 )( sample >> 8 );
+                bytes[ 2 ] = ( uint8 )( sample >> 16 );
+            }
+        }
+    }
+
+    inline void floatToInt32LE( const float* const* inBuffers, int numChannels, uint8* out, int length )
+    {
+        const float* in[ MAX_INTERLEAVED_CHANNELS ];
+        for ( int c = 0; c < numChannels; ++c )
+            in[ c ] = inBuffers[ c ];
+
+        // a float can not represent the largest 32-bit integer, saturate in double precision
+
+        for ( int i = 0; i < length; ++i )
+        {
+            for ( int c = 0; c < numChannels; ++c )
+            {
+                double value = ( double ) in[ c ][ i ] * 2147483648.0;
+                value = value < -2147483648.0 ? -2147483648.0 : value;
+                value = value >  2147483647.0 ?  2147483647.0 : value;
+                int32 sample = ( int32 )( value + ( value < 0.0 ? -.5 : .5 ));
+                memcpy( out + ( i * numChannels + c ) * sizeof( int32 ), &sample, sizeof( int32 ));
+            }
+        }
+    }
+
+    inline void floatToFloat32LE( const float* const* inBuffers, int numChannels, uint8* out, int length )
+    {
+        const float* in[ MAX_INTERLEAVED_CHANNELS ];
+        for ( int c = 0; c < numChannels; ++c )
+            in[ c ] = inBuffers[ c ];
+
+        for ( int i = 0; i < length; ++i )
+        {
+            for ( int c = 0; c < numChannels; ++c )
+                memcpy( out + ( i * numChannels + c ) * sizeof( float ), &in[ c ][ i ], sizeof( float ));
+        }
+    }
+
+    inline void floatToFloat64LE( const float* const* inBuffers, int numChannels, uint8* out, int length )
+    {
+        const float* in[ MAX_INTERLEAVED_CHANNELS ];
+        for ( int c = 0; c < numChannels; ++c )
+            in[ c ] = inBuffers[ c ];
+
+        for ( int i = 0; i < length; ++i )
+        {
+            for ( int c = 0; c < numChannels; ++c )
+            {
+                double sample = ( double ) in[ c ][ i ];
+                memcpy( out + ( i * numChannels + c ) * sizeof( double ), &sample, sizeof( double ));
+            }
+        }
+    }
+}
+}
+
+#endif
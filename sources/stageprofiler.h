@@ -0,0 +1,351 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __STAGEPROFILER_HEADER__
+#define __STAGEPROFILER_HEADER__
+
+/**
+ * optional instrumentation measuring the time spent in each stage of
+ * RegraderProcess::process. The instrumentation is only compiled in when
+ * REGRADER_PROFILE is defined (building the library and the tools with
+ * make PROFILE=true), otherwise the REGRADER_PROFILE_* macros expand to
+ * nothing. regrader-latency reports the measurements when it is enabled
+ *
+ * the audio thread pushes a measurement into a fixed-size single producer,
+ * single consumer ring upon leaving each stage. The ring never blocks nor
+ * allocates: when it is full, measurements are dropped (and counted). A
+ * non real-time thread (e.g. the UI or an offline tool) drains the ring
+ * into a StageStatistics to aggregate the measurements
+ *
+ * timings are in nanoseconds of std::chrono::steady_clock, or in CPU
+ * cycles as counted by the time stamp counter when REGRADER_PROFILE_TSC
+ * is defined as well (on x86 only)
+ */
+#ifdef REGRADER_PROFILE
+
+#include "global.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined( REGRADER_PROFILE_TSC ) && ( defined( __i386__ ) || defined( __x86_64__ ) || defined( _M_IX86 ) || defined( _M_X64 ))
+#   ifdef _MSC_VER
+#       include <intrin.h>
+#   else
+#       include <x86intrin.h>
+#   endif
+#   define REGRADER_PROFILE_USES_TSC 1
+#endif
+
+namespace Igorski {
+namespace StageProfiler {
+
+    enum Stage {
+        kPrepareMixBuffers = 0,
+        kBitCrusherPreMix,
+        kDecimatorPreMix,
+        kFilterPreMix,
+        kFlangerPreMix,
+        kDelayLoop,
+        kDecimatorPostMix,
+        kBitCrusherPostMix,
+        kFilterPostMix,
+        kFlangerPostMix,
+        kMix,
+        kLimiter,
+        kStageCount
+    };
+
+    inline const char* getStageName( int stage )
+    {
+        static const char* names[ kStageCount ] = {
+            "prepare mix buffers",
+            "bit crusher (pre mix)",
+            "decimator (pre mix)",
+            "filter (pre mix)",
+            "flanger (pre mix)",
+            "delay loop",
+            "decimator (post mix)",
+            "bit crusher (post mix)",
+            "filter (post mix)",
+            "flanger (post mix)",
+            "mix",
+            "limiter"
+        };
+        return ( stage >= 0 && stage < kStageCount ) ? names[ stage ] : "unknown";
+    }
+
+    // the unit of the timestamps returned by now()
+
+    inline const char* getTimeUnit()
+    {
+#ifdef REGRADER_PROFILE_USES_TSC
+        return "cycles";
+#else
+        return "ns";
+#endif
+    }
+
+    inline uint64 now()
+    {
+#ifdef REGRADER_PROFILE_USES_TSC
+        return ( uint64 ) __rdtsc();
+#else
+        return ( uint64 ) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+#endif
+    }
+
+    struct Measurement
+    {
+        uint64 duration;  // in getTimeUnit() units
+        int32  frames;    // amount of sample frames processed by the stage
+        int16  stage;     // see Stage enum
+        int16  channel;   // channel index or -1 when the stage processes all channels
+    };
+
+    class Ring
+    {
+        // must be a power of two
+
+        static const uint32 SIZE = 4096;
+
+        static const uintptr_t CACHE_LINE = 64;
+
+        public:
+            // the indices are aligned to cache lines, which operator new does not
+            // guarantee before C++17, so rings are created in aligned storage
+
+            static Ring* create()
+            {
+                // the address of the allocation is kept in front of the aligned ring
+
+                char* allocation = ( char* ) malloc( sizeof( Ring ) + CACHE_LINE + sizeof( void* ));
+
+                if ( allocation == 0 )
+                    throw std::bad_alloc();
+
+                uintptr_t address = (( uintptr_t )( allocation + sizeof( void* )) + CACHE_LINE - 1 ) & ~( CACHE_LINE - 1 );
+                (( void** ) address )[ -1 ] = allocation;
+
+                return new (( void* ) address ) Ring();
+            }
+
+            static void destroy( Ring* ring )
+            {
+                void* allocation = (( void** ) ring )[ -1 ];
+
+                ring->~Ring();
+                free( allocation );
+            }
+
+            // invoked by the audio thread only
+
+            inline void push( const Measurement& measurement )
+            {
+                uint32 writeIndex = _writeIndex.load( std::memory_order_relaxed );
+
+                if ( writeIndex - _readIndex.load( std::memory_order_acquire ) >= SIZE ) {
+                    _dropped.fetch_add( 1, std::memory_order_relaxed );
+                    return;
+                }
+                _measurements[ writeIndex & ( SIZE - 1 )] = measurement;
+                _writeIndex.store( writeIndex + 1, std::memory_order_release );
+            }
+
+            // invoked by the consuming thread only, returns false when the ring is empty
+
+            inline bool pop( Measurement& measurement )
+            {
+                uint32 readIndex = _readIndex.load( std::memory_order_relaxed );
+
+                if ( readIndex == _writeIndex.load( std::memory_order_acquire ))
+                    return false;
+
+                measurement = _measurements[ readIndex & ( SIZE - 1 )];
+                _readIndex.store( readIndex + 1, std::memory_order_release );
+
+                return true;
+            }
+
+            // amount of measurements dropped as the ring was full, resets the count
+
+            inline uint32 takeDropped()
+            {
+                return _dropped.exchange( 0, std::memory_order_relaxed );
+            }
+
+        private:
+            Measurement _measurements[ SIZE ];
+
+            // the indices are kept on separate cache lines as each is written by another thread
+
+            alignas( CACHE_LINE ) std::atomic<uint32> _writeIndex;
+            alignas( CACHE_LINE ) std::atomic<uint32> _readIndex;
+            alignas( CACHE_LINE ) std::atomic<uint32> _dropped;
+
+            Ring() : _writeIndex( 0 ), _readIndex( 0 ), _dropped( 0 ) {}
+    };
+
+    // measures the lifetime of its scope and pushes it into the ring on destruction
+
+    class Scope
+    {
+        public:
+            inline Scope( Ring* ring, int stage, int channel, int frames )
+                : _ring( ring ), _start( now()), _stage( stage ), _channel( channel ), _frames( frames ) {}
+
+            inline ~Scope()
+            {
+                record( _ring, _start, _stage, _channel, _frames );
+            }
+
+            // pushes the time elapsed since given start timestamp into given ring
+
+            static inline void record( Ring* ring, uint64 start, int stage, int channel, int frames )
+            {
+                Measurement measurement;
+
+                measurement.duration = now() - start;
+                measurement.frames   = ( int32 ) frames;
+                measurement.stage    = ( int16 ) stage;
+                measurement.channel  = ( int16 ) channel;
+
+                ring->push( measurement );
+            }
+
+        private:
+            Ring* _ring;
+            uint64 _start;
+            int _stage;
+            int _channel;
+            int _frames;
+    };
+
+    // aggregates drained measurements per stage, not to be used on the audio thread
+
+    class StageStatistics
+    {
+        public:
+            StageStatistics() { clear(); }
+
+            void clear()
+            {
+                for ( int i = 0; i < kStageCount; ++i ) {
+                    count[ i ]    = 0;
+                    total[ i ]    = 0;
+                    maximum[ i ]  = 0;
+                    frames[ i ]   = 0;
+                }
+                dropped = 0;
+            }
+
+            // moves all measurements currently in given ring into the statistics
+
+            void drain( Ring* ring )
+            {
+                Measurement measurement;
+
+                while ( ring->pop( measurement )) {
+                    int stage = measurement.stage;
+
+                    if ( stage < 0 || stage >= kStageCount )
+                        continue;
+
+                    ++count[ stage ];
+                    total[ stage ]  += measurement.duration;
+                    frames[ stage ] += ( uint64 ) measurement.frames;
+
+                    if ( measurement.duration > maximum[ stage ])
+                        maximum[ stage ] = measurement.duration;
+                }
+                dropped += ring->takeDropped();
+            }
+
+            // writes a table of the aggregated measurements to given stream
+
+            void print( FILE* stream ) const
+            {
+                const char* unit = getTimeUnit();
+                uint64 sum = 0;
+
+                for ( int i = 0; i < kStageCount; ++i )
+                    sum += total[ i ];
+
+                fprintf( stream, "%-24s %10s %18s %18s %16s %7s\n",
+                         "stage", "count", "mean", "max", "per frame", "share" );
+
+                for ( int i = 0; i < kStageCount; ++i ) {
+                    if ( count[ i ] == 0 )
+                        continue;
+
+                    fprintf( stream, "%-24s %10llu %11.1f %-6s %11llu %-6s %9.2f %-6s %6.1f%%\n",
+                             getStageName( i ), ( unsigned long long ) count[ i ],
+                             ( double ) total[ i ] / ( double ) count[ i ], unit,
+                             ( unsigned long long ) maximum[ i ], unit,
+                             frames[ i ] > 0 ? ( double ) total[ i ] / ( double ) frames[ i ] : 0.0, unit,
+                             sum > 0 ? 100.0 * ( double ) total[ i ] / ( double ) sum : 0.0 );
+                }
+                if ( dropped > 0 )
+                    fprintf( stream, "%llu measurements were dropped\n", ( unsigned long long ) dropped );
+            }
+
+            uint64 count[ kStageCount ];
+            uint64 total[ kStageCount ];
+            uint64 maximum[ kStageCount ];
+            uint64 frames[ kStageCount ];
+            uint64 dropped;
+    };
+}
+}
+
+#define REGRADER_PROFILE_CONCAT_( a, b ) a##b
+#define REGRADER_PROFILE_CONCAT( a, b ) REGRADER_PROFILE_CONCAT_( a, b )
+
+// measures the remainder of the enclosing scope as given stage
+
+#define REGRADER_PROFILE_STAGE( ring, stage, channel, frames ) \
+    Igorski::StageProfiler::Scope REGRADER_PROFILE_CONCAT( __profileScope, __LINE__ )( \
+        ring, Igorski::StageProfiler::stage, channel, frames \
+    )
+
+// measures the statements between a BEGIN and END sharing the same name as given stage
+
+#define REGRADER_PROFILE_BEGIN( name ) \
+    uint64 name = Igorski::StageProfiler::now()
+
+#define REGRADER_PROFILE_END( ring, name, stage, channel, frames ) \
+    Igorski::StageProfiler::Scope::record( ring, name, Igorski::StageProfiler::stage, channel, frames )
+
+#else
+
+#define REGRADER_PROFILE_STAGE( ring, stage, channel, frames ) do {} while ( 0 )
+#define REGRADER_PROFILE_BEGIN( name ) do {} while ( 0 )
+#define REGRADER_PROFILE_END( ring, name, stage, channel, frames ) do {} while ( 0 )
+
+#endif
+
+#endif
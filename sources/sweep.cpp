@@ -0,0 +1,68 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "sweep.h"
+
+namespace Igorski {
+
+Sweep::Sweep() {
+    _range       = 0.f;
+    _step        = 0.f;
+    _value       = 0.f;
+    _valueStored = 0.f;
+}
+
+Sweep::~Sweep() {
+
+}
+
+/* public methods */
+
+void Sweep::setRange( float range, float step )
+{
+    _range = range;
+    _step  = step;
+    _value = 0.f;
+}
+
+float Sweep::getRange()
+{
+    return _range;
+}
+
+void Sweep::store()
+{
+    _valueStored = _value;
+}
+
+void Sweep::restore()
+{
+    _value = _valueStored;
+}
+
+void Sweep::advance( int samples )
+{
+    for ( int i = 0; i < samples; ++i )
+        peek();
+}
+
+}
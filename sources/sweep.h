@@ -0,0 +1,87 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __SWEEP_H_INCLUDED__
+#define __SWEEP_H_INCLUDED__
+
+namespace Igorski {
+
+/**
+ * a triangular sweep between 0 and a range (e.g. the modulation
+ * of the flanger delay), moving up from 0 at a fixed step per sample
+ */
+class Sweep {
+
+    public:
+        Sweep();
+        ~Sweep();
+
+        // sets the upper bound of the sweep and the distance it travels per
+        // sample, which restarts the sweep at 0
+
+        void setRange( float range, float step );
+        float getRange();
+
+        // store/restore the position of the sweep. Note its direction is not restored, when
+        // the sweep reverses while processing a channel the next channel sweeps the other way
+
+        void store();
+        void restore();
+
+        // moves the sweep along by given amount of samples, as if
+        // peek() had been invoked as many times
+
+        void advance( int samples );
+
+        /**
+         * retrieve the current position of the sweep and move it
+         * along, reversing its direction at either bound
+         */
+        inline float peek()
+        {
+            float value = _value;
+
+            if ( _step != 0.f )
+            {
+                _value += _step;
+
+                if ( _value <= 0.f )
+                {
+                    _value = 0.f;
+                    _step  = -_step;
+                }
+                else if ( _value >= _range )
+                    _step = -_step;
+            }
+            return value;
+        }
+
+    private:
+        float _range;
+        float _step;
+        float _value;
+
+        float _valueStored;
+};
+}
+
+#endif
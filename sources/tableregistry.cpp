@@ -0,0 +1,145 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "tableregistry.h"
+#include <map>
+#include <mutex>
+#include <math.h>
+
+namespace Igorski {
+
+namespace {
+
+    typedef std::pair<int, float> TableKey;
+
+    std::mutex tablesMutex;
+    std::map<TableKey, std::weak_ptr<const LookupTable>> tables;
+
+    const int PREWARP_TABLE_SIZE = 4096;
+    const double PI = 3.14159265358979323846;
+
+    // shape of the window of the true peak kernel
+
+    const double TRUE_PEAK_KAISER_BETA = 5.0;
+
+    // zeroth order modified Bessel function of the first kind, for the Kaiser window
+
+    double besselI0( double x )
+    {
+        double sum  = 1.0;
+        double term = 1.0;
+
+        for ( int k = 1; k < 32; ++k ) {
+            double factor = x / ( 2.0 * k );
+            term *= factor * factor;
+            sum  += term;
+        }
+        return sum;
+    }
+}
+
+LookupTable::LookupTable( int size, float scale )
+{
+    _size  = size;
+    _scale = scale;
+    _data.resize( size + 1 );
+}
+
+/* public methods */
+
+TableRegistry::Table TableRegistry::acquire( TableKind kind, float sampleRate )
+{
+    std::lock_guard<std::mutex> lock( tablesMutex );
+
+    if ( kind == kTruePeakKernel )
+        sampleRate = 0.f; // shared across sample rates
+
+    std::weak_ptr<const LookupTable>& entry = tables[ TableKey( kind, sampleRate )];
+    Table table = entry.lock();
+
+    if ( !table ) {
+        table = build( kind, sampleRate );
+        entry = table;
+    }
+    return table;
+}
+
+/* private methods */
+
+TableRegistry::Table TableRegistry::build( TableKind kind, float sampleRate )
+{
+    LookupTable* table = 0;
+
+    switch ( kind )
+    {
+        case kFilterPrewarp:
+        {
+            double nyquist = sampleRate / 2.0;
+            table = new LookupTable( PREWARP_TABLE_SIZE, ( float )( PREWARP_TABLE_SIZE / nyquist ));
+
+            // stay just below the nyquist frequency where tan() is infinite
+
+            for ( int i = 0; i <= PREWARP_TABLE_SIZE; ++i ) {
+                double frequency = std::min( i * nyquist / PREWARP_TABLE_SIZE, nyquist * 0.9999 );
+                table->_data[ i ] = ( float ) tan( PI * frequency / sampleRate );
+            }
+            break;
+        }
+
+        case kTruePeakKernel:
+        {
+            // a Kaiser windowed sinc low pass at the nyquist frequency of the original rate,
+            // oversampled TRUE_PEAK_PHASES times. Each phase is normalized to unity gain at DC
+
+            const int length = TRUE_PEAK_PHASES * TRUE_PEAK_TAPS;
+            double centre    = ( length - 1 ) / 2.0;
+
+            table = new LookupTable( length, 0.f );
+
+            for ( int p = 0; p < TRUE_PEAK_PHASES; ++p )
+            {
+                double coefficients[ TRUE_PEAK_TAPS ];
+                double sum = 0.0;
+
+                for ( int k = 0; k < TRUE_PEAK_TAPS; ++k ) {
+                    double n      = k * TRUE_PEAK_PHASES + p;
+                    double x      = ( n - centre ) / TRUE_PEAK_PHASES;
+                    double r      = ( n - centre ) / centre;
+                    double sinc   = ( x == 0.0 ) ? 1.0 : sin( PI * x ) / ( PI * x );
+                    double window = besselI0( TRUE_PEAK_KAISER_BETA * sqrt( 1.0 - r * r )) / besselI0( TRUE_PEAK_KAISER_BETA );
+
+                    coefficients[ k ] = sinc * window;
+                    sum += coefficients[ k ];
+                }
+
+                // the k-th coefficient applies onto the k-th newest sample
+
+                for ( int k = 0; k < TRUE_PEAK_TAPS; ++k )
+                    table->_data[( TRUE_PEAK_TAPS - 1 - k ) * TRUE_PEAK_PHASES + p ] = ( float )( coefficients[ k ] / sum );
+            }
+            break;
+        }
+    }
+    return Table( table );
+}
+
+}
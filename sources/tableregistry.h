@@ -0,0 +1,97 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __TABLEREGISTRY_H_INCLUDED__
+#define __TABLEREGISTRY_H_INCLUDED__
+
+#include "global.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/**
+ * the TableRegistry provides read-only lookup tables which are shared
+ * by all processors in the process. A table is built the first time it is
+ * acquired for a given kind and sample rate and is freed once the last
+ * processor referencing it has released it
+ *
+ * tables should be acquired upon construction of a processor as building
+ * a table allocates memory and acquiring one locks the registry
+ */
+namespace Igorski {
+
+class LookupTable
+{
+    public:
+        LookupTable( int size, float scale );
+
+        // linearly interpolated value of the table for given argument
+        // arguments outside of the table range are clamped
+
+        inline float lookup( float argument ) const
+        {
+            float position = std::max( 0.f, argument * _scale );
+            int index      = std::min(( int ) position, _size - 1 );
+            float fraction = std::min( 1.f, position - ( float ) index );
+
+            return _data[ index ] + ( _data[ index + 1 ] - _data[ index ] ) * fraction;
+        }
+
+        int getSize() const { return _size; }
+        const float* getData() const { return _data.data(); }
+
+    private:
+        friend class TableRegistry;
+
+        int _size;                // amount of points, excluding the guard point
+        float _scale;             // multiplier converting an argument into a table position
+        std::vector<float> _data; // the points followed by a guard point for the interpolation
+};
+
+class TableRegistry
+{
+    public:
+        enum TableKind {
+            kFilterPrewarp,  // tan( PI * frequency / sampleRate ) for frequencies up to the nyquist frequency
+            kTruePeakKernel, // the polyphase FIR interpolating true peaks, independent of the sample rate
+        };
+
+        // the true peak kernel interpolates TRUE_PEAK_PHASES points between each pair of samples
+        // from the TRUE_PEAK_TAPS preceding samples. The coefficient applied onto the j-th oldest
+        // sample for the p-th point is found at index j * TRUE_PEAK_PHASES + p. The points lie
+        // between the samples TRUE_PEAK_TAPS / 2 and TRUE_PEAK_TAPS / 2 - 1 before the newest
+
+        static const int TRUE_PEAK_PHASES = 4;
+        static const int TRUE_PEAK_TAPS   = 12;
+
+        typedef std::shared_ptr<const LookupTable> Table;
+
+        // retrieve the table of given kind for given sample rate
+
+        static Table acquire( TableKind kind, float sampleRate );
+
+    private:
+        static Table build( TableKind kind, float sampleRate );
+};
+}
+
+#endif
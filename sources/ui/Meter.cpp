@@ -0,0 +1,85 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Meter.h"
+#include "Cairo.hpp"
+#include "Window.hpp"
+#include <algorithm>
+#include <cmath>
+
+///
+Meter::Meter(uint32_t frameColor, uint32_t fillColor, uint32_t peakColor, Widget *group)
+    : CControl(group), fFrameColor(frameColor), fFillColor(fillColor), fPeakColor(peakColor)
+{
+}
+
+double Meter::_normalize(double value) const
+{
+    double range = fValueBound2 - fValueBound1;
+    if (range == 0)
+        return 0;
+    return std::max(0.0, std::min(1.0, (value - fValueBound1) / range));
+}
+
+void Meter::setValueBounds(double v1, double v2)
+{
+    fValueBound1 = v1;
+    fValueBound2 = v2;
+    repaint();
+}
+
+void Meter::setPeak(double peak)
+{
+    if (peak == fPeak)
+        return;
+
+    fPeak = peak;
+    repaint();
+}
+
+void Meter::onDisplay()
+{
+    cairo_t *cr = getParentWindow().getGraphicsContext().cairo;
+
+    double w = getWidth();
+    double h = getHeight();
+
+    double fill = _normalize(getValue()) * (w - 2);
+    if (fill > 0) {
+        cairo_rectangle(cr, 1, 1, fill, h - 2);
+        cairo_set_source_rgba32(cr, fFillColor);
+        cairo_fill(cr);
+    }
+
+    double peak = std::round(_normalize(fPeak) * (w - 2));
+    if (peak > 0) {
+        cairo_move_to(cr, peak + 0.5, 1);
+        cairo_line_to(cr, peak + 0.5, h - 1);
+        cairo_set_source_rgba32(cr, fPeakColor);
+        cairo_stroke(cr);
+    }
+
+    cairo_rectangle(cr, 0.5, 0.5, w, h);
+    cairo_set_source_rgba32(cr, fFrameColor);
+    cairo_stroke(cr);
+}
@@ -0,0 +1,51 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include "Control.h"
+#include "CairoExtra.h"
+
+/**
+  A read-only horizontal bar displaying a value within its bounds,
+  along with a marker for the peak value.
+*/
+class Meter final : public CControl
+{
+public:
+    Meter(uint32_t frameColor, uint32_t fillColor, uint32_t peakColor, Widget *group);
+
+    void setValueBounds(double v1, double v2);
+
+    double getPeak() const { return fPeak; }
+    void setPeak(double peak);
+
+    void onDisplay() override;
+
+private:
+    double _normalize(double value) const;
+
+private:
+    float fValueBound1 = 0, fValueBound2 = 1;
+    double fPeak = 0;
+    uint32_t fFrameColor = 0, fFillColor = 0, fPeakColor = 0;
+};
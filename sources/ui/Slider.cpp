@@ -158,9 +158,11 @@ void Slider::onDisplay()
 {
     cairo_t *cr = getParentWindow().getGraphicsContext().cairo;
 
+    // the body image is repeated or cropped to the size of the widget
     cairo_surface_t *imgBody = fImgBody;
-    int wBody = cairo_image_surface_get_width(imgBody);
-    int hBody = cairo_image_surface_get_height(imgBody);
+    DGL::Size<uint> wsize = getSize();
+    int wBody = wsize.getWidth();
+    int hBody = wsize.getHeight();
 
     cairo_surface_t *imgHandle = fImgHandle;
     int wHandle = cairo_image_surface_get_width(imgHandle);
@@ -172,6 +174,7 @@ void Slider::onDisplay()
     //
     cairo_rectangle(cr, 0, 0, wBody, hBody);
     cairo_set_source_surface(cr, imgBody, 0, 0);
+    cairo_pattern_set_extend(cairo_get_source(cr), CAIRO_EXTEND_REPEAT);
     cairo_fill(cr);
 
     int xHandle = 0;
@@ -0,0 +1,157 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __WAVETABLES_HEADER__
+#define __WAVETABLES_HEADER__
+
+#include "global.h"
+
+/**
+ * single cycle waveforms for the oscillators, generated by the compiler
+ *
+ * each table holds SIZE entries followed by two guard points repeating the
+ * first entries, so a position anywhere from 0 up to and including SIZE can
+ * be linearly interpolated without wrapping the index. The tables are read
+ * only and shared by all oscillators of all instances
+ */
+namespace Igorski {
+namespace WaveTables {
+
+    enum Shape {
+        kSine = 0,
+        kTriangle,
+        kSaw,
+        kSquare,
+        kSampleAndHold,
+        kNumShapes
+    };
+
+    static const int SIZE = 2048;
+
+    // the amount of random steps per cycle of the sample and hold shape
+
+    static const int SAMPLE_AND_HOLD_STEPS = 16;
+
+    namespace Generate {
+
+        // C++11 constexpr functions consist of a single return statement, hence the
+        // recursion and the conditional expressions. The phases are given as an
+        // index into the cycle, which keeps the range reduction exact
+
+        // the Taylor series of sin( x ) for x in the -PI to +PI range, where the terms
+        // beyond x^25 / 25! fall below the precision of a double
+
+        constexpr double sineSeries( double x2, double term, int n )
+        {
+            return ( n > 25 ) ? 0.0 : term + sineSeries( x2, -term * x2 / (( n + 1.0 ) * ( n + 2.0 )), n + 2 );
+        }
+
+        constexpr double sineOfRadians( double x )
+        {
+            return sineSeries( x * x, x, 1 );
+        }
+
+        // the radians of given index, moved into the -PI to +PI range
+
+        constexpr double radians( int index )
+        {
+            return 6.283185307179586 * (( index % SIZE ) < SIZE / 2 ? index % SIZE : ( index % SIZE ) - SIZE ) / SIZE;
+        }
+
+        // the phase of given index in the 0 - 1 range
+
+        constexpr double phase( int index )
+        {
+            return ( double ) ( index % SIZE ) / SIZE;
+        }
+
+        // a hash of the step index, spread over the -1 to +1 range
+
+        constexpr uint32 mix( uint32 value )
+        {
+            return ( value ^ ( value >> 15 )) * 0x2c1b3c6dU;
+        }
+
+        constexpr double random( uint32 step )
+        {
+            return ( mix( mix( step * 0x9e3779b9U + 0x7f4a7c15U )) >> 8 ) / 8388607.5 - 1.0;
+        }
+
+        // all shapes start at 0 (or the first random step), rising where they have a slope
+
+        constexpr float sample( int shape, int index )
+        {
+            return ( float ) (
+                ( shape == kSine )     ? sineOfRadians( radians( index )) :
+                ( shape == kTriangle ) ? ( phase( index ) < .25 ? 4.0 * phase( index ) :
+                                         phase( index ) < .75 ? 2.0 - 4.0 * phase( index ) : 4.0 * phase( index ) - 4.0 ) :
+                ( shape == kSaw )      ? ( phase( index ) < .5 ? 2.0 * phase( index ) : 2.0 * phase( index ) - 2.0 ) :
+                ( shape == kSquare )   ? ( phase( index ) < .5 ? 1.0 : -1.0 ) :
+                random(( uint32 ) ( index % SIZE ) / ( SIZE / SAMPLE_AND_HOLD_STEPS ))
+            );
+        }
+
+        // a pack of the indices 0 to N - 1, concatenated from halves to keep the
+        // template instantiation depth logarithmic in the size of the tables
+
+        template <int... I> struct Indices {};
+
+        template <typename A, typename B> struct Concat;
+
+        template <int... A, int... B> struct Concat<Indices<A...>, Indices<B...>> {
+            typedef Indices<A..., ( int ) sizeof...( A ) + B...> Type;
+        };
+
+        template <int N> struct MakeIndices {
+            typedef typename Concat<typename MakeIndices<N / 2>::Type, typename MakeIndices<N - N / 2>::Type>::Type Type;
+        };
+
+        template <> struct MakeIndices<0> { typedef Indices<> Type; };
+        template <> struct MakeIndices<1> { typedef Indices<0> Type; };
+
+        template <typename Pack> struct Tables;
+
+        template <int... I> struct Tables<Indices<I...>> {
+            static constexpr float values[ kNumShapes ][ sizeof...( I ) ] = {
+                { sample( kSine, I )... },
+                { sample( kTriangle, I )... },
+                { sample( kSaw, I )... },
+                { sample( kSquare, I )... },
+                { sample( kSampleAndHold, I )... },
+            };
+        };
+
+        template <int... I> constexpr float Tables<Indices<I...>>::values[ kNumShapes ][ sizeof...( I ) ];
+
+        typedef Tables<MakeIndices<SIZE + 2>::Type> All;
+    }
+
+    // the table of given shape (see Shape)
+
+    inline const float* get( int shape )
+    {
+        return Generate::All::values[ shape ];
+    }
+}
+}
+
+#endif
@@ -0,0 +1,375 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// measures the worst case processing latency of RegraderProcess on a real-time
+// thread which simulates the periods of an audio device, while automating
+// the parameters at random through the same model as the plugin
+
+#include "regraderprocess.h"
+#include "regradermodel.h"
+#include "rtcheck.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace Igorski;
+
+struct Options
+{
+    int frames = 64;
+    double sampleRate = 48000;
+    double seconds = 30;
+    unsigned seed = 1;
+    int priority = 80;
+    double automationRate = 0.25; // probability of a parameter change per period
+    bool varyFrames = false;
+};
+
+struct Harness
+{
+    Options options;
+    RegraderProcess *process = nullptr;
+    RegraderModel model;
+
+    std::vector<uint32_t> latencies; // nanoseconds from the start of a period to the end of its processing
+    uint64_t periodNs = 0;
+    uint64_t xruns = 0;
+    bool realtime = false;
+    int schedulingError = 0;
+
+    std::atomic<bool> finished{false}; // set by the audio thread after its last period
+#ifdef REGRADER_PROFILE
+    StageProfiler::StageStatistics stages;
+#endif
+};
+
+// small and allocation-free random generator for use on the audio thread
+
+struct Random
+{
+    uint32_t state;
+
+    explicit Random(uint32_t seed) : state(seed ? seed : 1) {}
+
+    uint32_t next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    float uniform() { return (next() >> 8) * (1.f / 16777216.f); }
+};
+
+static uint64_t toNs(const timespec &ts)
+{
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static timespec fromNs(uint64_t ns)
+{
+    timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ull);
+    ts.tv_nsec = (long)(ns % 1000000000ull);
+    return ts;
+}
+
+static uint64_t nowNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return toNs(ts);
+}
+
+static void automate(Harness &h, Random &random)
+{
+    if (random.uniform() >= h.options.automationRate)
+        return;
+
+    int id;
+    do {
+        id = (int)(random.next() % kNumParameters);
+    } while (RegraderModel::isOutput(id));
+
+    // the same path as PluginRegrader::setParameterValue
+
+    h.model.setValue(id, random.uniform());
+    h.model.apply(h.process);
+}
+
+static void *audioThread(void *arg)
+{
+    Harness &h = *(Harness *)arg;
+    const Options &o = h.options;
+
+    Random random(o.seed);
+
+    std::vector<float> buffers(4 * o.frames, 0.f);
+    float *in[2] = { &buffers[0], &buffers[o.frames] };
+    float *out[2] = { &buffers[2 * o.frames], &buffers[3 * o.frames] };
+
+    // the input alternates between a second of noise and a second of silence,
+    // the latter lets the feedback decay into the denormal range
+
+    uint64_t frame = 0;
+    uint64_t burstFrames = (uint64_t)o.sampleRate;
+    double tempo = 120;
+
+    uint64_t periodStart = nowNs();
+
+    for (size_t block = 0; block < h.latencies.size(); ++block) {
+        periodStart += h.periodNs;
+        timespec wakeup = fromNs(periodStart);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, nullptr) != 0);
+
+        REGRADER_RT_SCOPE;
+
+        int frames = o.varyFrames ? 1 + (int)(random.next() % o.frames) : o.frames;
+
+        bool noise = ((frame / burstFrames) & 1) == 0;
+        for (int i = 0; i < frames; ++i) {
+            in[0][i] = noise ? random.uniform() * 2.f - 1.f : 0.f;
+            in[1][i] = noise ? random.uniform() * 2.f - 1.f : 0.f;
+        }
+        frame += frames;
+
+        // as PluginRegrader::run, apply the host tempo before processing
+
+        if (random.uniform() < 0.001f)
+            tempo = 60 + random.uniform() * 120;
+
+        automate(h, random);
+        h.process->setTempo(tempo, 4, 4);
+        h.process->process<float>(in, out, 2, 2, frames);
+
+        uint64_t end = nowNs();
+        uint64_t latency = end - std::min(end, periodStart);
+        h.latencies[block] = (uint32_t)std::min<uint64_t>(latency, UINT32_MAX);
+
+        // an overrun delays the following periods, as a device restarting after an xrun
+
+        if (latency > h.periodNs) {
+            ++h.xruns;
+            periodStart = end;
+        }
+    }
+
+    h.finished.store(true, std::memory_order_release);
+    return nullptr;
+}
+
+static bool runThread(Harness &h)
+{
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+
+    sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = h.options.priority;
+
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+
+    pthread_t thread;
+    int err = pthread_create(&thread, &attr, &audioThread, &h);
+    h.realtime = err == 0;
+
+    if (err == EPERM) {
+        // not allowed to run real-time, measure at the default priority instead
+        h.schedulingError = err;
+        err = pthread_create(&thread, nullptr, &audioThread, &h);
+    }
+    pthread_attr_destroy(&attr);
+
+    if (err != 0) {
+        fprintf(stderr, "Cannot create the audio thread: %s\n", strerror(err));
+        return false;
+    }
+
+#ifdef REGRADER_PROFILE
+    // the ring holds the stage measurements of a few hundred periods, drain it while
+    // the audio thread runs
+
+    while (!h.finished.load(std::memory_order_acquire)) {
+        h.stages.drain(h.process->profileRing);
+        usleep(10000);
+    }
+#endif
+
+    pthread_join(thread, nullptr);
+
+#ifdef REGRADER_PROFILE
+    h.stages.drain(h.process->profileRing);
+#endif
+    return true;
+}
+
+static double percentile(const std::vector<uint32_t> &sorted, double fraction)
+{
+    size_t index = (size_t)std::ceil(fraction * sorted.size());
+    index = std::min(sorted.size() - 1, index > 0 ? index - 1 : 0);
+    return sorted[index] * 1e-3;
+}
+
+static void report(const Harness &h)
+{
+    const Options &o = h.options;
+    double periodUs = h.periodNs * 1e-3;
+
+    printf("period: %d frames at %g Hz (%.1f us), %zu periods\n",
+           o.frames, o.sampleRate, periodUs, h.latencies.size());
+    if (h.realtime)
+        printf("scheduling: SCHED_FIFO, priority %d\n", o.priority);
+    else
+        printf("scheduling: SCHED_OTHER (%s)\n", strerror(h.schedulingError));
+    printf("\n");
+
+    // histogram with bounds relative to the period
+
+    static const double bounds[] = { 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1.0, 2.0, HUGE_VAL };
+    const int numBuckets = sizeof(bounds) / sizeof(bounds[0]);
+    uint64_t counts[numBuckets] = {};
+
+    for (uint32_t latency : h.latencies) {
+        int bucket = 0;
+        while (latency * 1e-3 >= bounds[bucket] * periodUs)
+            ++bucket;
+        ++counts[bucket];
+    }
+
+    uint64_t maxCount = *std::max_element(counts, counts + numBuckets);
+
+    printf("%-24s %10s\n", "latency (us)", "periods");
+    for (int i = 0; i < numBuckets; ++i) {
+        double lower = (i > 0) ? bounds[i - 1] * periodUs : 0.0;
+        char range[64];
+        if (std::isinf(bounds[i]))
+            snprintf(range, sizeof(range), "%9.1f and over", lower);
+        else
+            snprintf(range, sizeof(range), "%9.1f - %9.1f", lower, bounds[i] * periodUs);
+
+        int bar = maxCount ? (int)std::ceil(40.0 * counts[i] / maxCount) : 0;
+        printf("%-24s %10llu %s\n", range, (unsigned long long)counts[i], std::string(bar, '#').c_str());
+    }
+    printf("\n");
+
+    std::vector<uint32_t> sorted(h.latencies);
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0;
+    for (uint32_t latency : sorted)
+        sum += latency * 1e-3;
+
+    double mean = sum / sorted.size();
+    double p50 = percentile(sorted, 0.5);
+    double p99 = percentile(sorted, 0.99);
+    double p999 = percentile(sorted, 0.999);
+    double max = sorted.back() * 1e-3;
+
+    printf("mean:  %9.1f us (%5.1f%% of period)\n", mean, 100 * mean / periodUs);
+    printf("p50:   %9.1f us (%5.1f%% of period)\n", p50, 100 * p50 / periodUs);
+    printf("p99:   %9.1f us (%5.1f%% of period)\n", p99, 100 * p99 / periodUs);
+    printf("p99.9: %9.1f us (%5.1f%% of period)\n", p999, 100 * p999 / periodUs);
+    printf("max:   %9.1f us (%5.1f%% of period)\n", max, 100 * max / periodUs);
+    printf("xruns: %llu\n", (unsigned long long)h.xruns);
+
+#ifdef REGRADER_PROFILE
+    printf("\n");
+    h.stages.print(stdout);
+#endif
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "Usage: regrader-latency [options]\n"
+            "  -n <frames>    frames per period (default 64)\n"
+            "  -r <rate>      sample rate in Hz (default 48000)\n"
+            "  -t <seconds>   duration of the run (default 30)\n"
+            "  -s <seed>      seed of the randomized automation (default 1)\n"
+            "  -p <priority>  SCHED_FIFO priority of the audio thread (default 80)\n"
+            "  -a <rate>      probability of a parameter change per period (default 0.25)\n"
+            "  -v             vary the amount of frames per period, up to the given amount\n"
+            "\n"
+            "The exit status is 1 when any period overran.\n");
+}
+
+int main(int argc, char *argv[])
+{
+    Harness h;
+    Options &o = h.options;
+
+    for (int c; (c = getopt(argc, argv, "n:r:t:s:p:a:vh")) != -1;) {
+        switch (c) {
+        case 'n': o.frames = atoi(optarg); break;
+        case 'r': o.sampleRate = atof(optarg); break;
+        case 't': o.seconds = atof(optarg); break;
+        case 's': o.seed = (unsigned)strtoul(optarg, nullptr, 0); break;
+        case 'p': o.priority = atoi(optarg); break;
+        case 'a': o.automationRate = atof(optarg); break;
+        case 'v': o.varyFrames = true; break;
+        default: usage(); return (c == 'h') ? 0 : 2;
+        }
+    }
+
+    if (o.frames < 1 || o.sampleRate < 1 || o.seconds <= 0) {
+        usage();
+        return 2;
+    }
+
+    // keep the memory resident, page faults would show as latency spikes
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        fprintf(stderr, "Cannot lock the memory: %s\n", strerror(errno));
+
+    h.periodNs = (uint64_t)(1e9 * o.frames / o.sampleRate);
+    h.latencies.resize((size_t)std::max(1.0, o.seconds * o.sampleRate / o.frames));
+
+    h.process = new RegraderProcess(2, (float)o.sampleRate);
+    h.model.apply(h.process);
+
+    // allocate the buffers up front, as the plugin does when it is activated
+    h.process->setMaxBufferSize(o.frames);
+
+    bool ok = runThread(h);
+    delete h.process;
+
+    if (!ok)
+        return 2;
+
+    report(h);
+    return (h.xruns > 0) ? 1 : 0;
+}
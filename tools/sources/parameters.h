@@ -0,0 +1,50 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include "regradermodel.h"
+#include <cstdio>
+#include <cstdlib>
+
+// applies a parameter given on the command line as <id>=<value>, where id is the
+// index of the parameter in paramids.h and value is normalized in the 0 - 1 range
+inline bool parseParameter(const char *text, Igorski::RegraderModel &model)
+{
+    char *end;
+    long id = strtol(text, &end, 10);
+    if (end == text || *end != '=' || id < 0 || id >= kNumParameters ||
+        Igorski::RegraderModel::isOutput((int)id)) {
+        fprintf(stderr, "Invalid parameter: %s\n", text);
+        return false;
+    }
+
+    const char *valueText = end + 1;
+    float value = strtof(valueText, &end);
+    if (end == valueText || *end != '\0' || !(value >= 0 && value <= 1)) {
+        fprintf(stderr, "Invalid parameter value: %s\n", text);
+        return false;
+    }
+
+    model.setValue((int)id, value);
+    return true;
+}
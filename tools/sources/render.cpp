@@ -0,0 +1,538 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// renders WAVE files through the effect with the same parameters, writing the
+// results under the same names into an output directory
+//
+// the files are divided over a number of worker threads, each of which keeps a
+// single processor which is reset between files rather than reconstructed. The
+// files are mapped into memory, every worker has the system read its next file
+// ahead while the current one is processing. The samples are converted straight
+// between the mapped files and the buffers of the processor
+//
+// alternatively the files are rendered one at a time, each split into parts at
+// silences longer than the tail of the effect. Once the tail has decayed the state
+// of the processor only differs from a new one by its oscillators, so every part
+// is rendered on its own thread by a new processor with its oscillators advanced
+// to the start of the part. As the oscillators move along differently depending
+// on the block size, the parts start on the same blocks as a single render
+//
+// or, when the settings only use the effects a RegraderBank provides, the files
+// are rendered in groups of up to eight of the same format, each group through
+// a single bank with every file on its own lane
+
+#include "regraderbank.h"
+#include "regraderprocess.h"
+#include "regradermodel.h"
+#include "parameters.h"
+#include "wavfile.h"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+
+using namespace Igorski;
+
+struct Batch
+{
+    std::vector<const char *> inputs;
+    std::string outputDirectory;
+    RegraderModel model;
+    int blockFrames = 1024;
+    double tailSeconds = 0;
+    int jobs = 1;
+
+    // whether files are split at silences rather than rendered in parallel, and
+    // the level below which the input is silent and the tail considered decayed
+    bool split = false;
+    // whether files are rendered on the lanes of a bank rather than one at a time
+    bool bank = false;
+    float silence = 1.58489e-5f; // -96 dB
+
+    std::atomic<size_t> nextInput{0};
+    std::atomic<int> failures{0};
+};
+
+struct LoadedFile
+{
+    const char *path = nullptr;
+    std::unique_ptr<WavReader> reader;
+    std::string error; // empty when the file was opened
+};
+
+static LoadedFile loadFile(const char *path)
+{
+    LoadedFile loaded;
+    loaded.path = path;
+    loaded.reader.reset(new WavReader);
+
+    if (!loaded.reader->open(path, loaded.error))
+        return loaded;
+
+    if (loaded.reader->getFormat().channels > 2)
+        loaded.error = std::string(path) + " has more than 2 channels";
+    else
+        loaded.reader->prefetch();
+    return loaded;
+}
+
+static std::future<LoadedFile> loadNextFile(Batch &batch)
+{
+    size_t index = batch.nextInput++;
+    if (index >= batch.inputs.size())
+        return std::future<LoadedFile>();
+    return std::async(std::launch::async, &loadFile, batch.inputs[index]);
+}
+
+static std::string getOutputPath(const Batch &batch, const char *input)
+{
+    const char *name = strrchr(input, '/');
+    name = name ? name + 1 : input;
+    return batch.outputDirectory + '/' + name;
+}
+
+static size_t getOutputFrames(const Batch &batch, const WavReader &input)
+{
+    return input.getFrames() + (size_t)(batch.tailSeconds * input.getFormat().sampleRate);
+}
+
+static void finishOutput(Batch &batch, WavWriter &output)
+{
+    std::string error;
+    if (!output.close(error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        ++batch.failures;
+    }
+}
+
+// processes the frames from start to end of the input into the output using
+// blocks of a constant size, so the processor keeps its mix buffers. The last
+// block is padded with silence
+static void renderFrames(const Batch &batch, RegraderProcess &process, const WavReader &input, WavWriter &output,
+                         size_t start, size_t end, std::vector<float> &scratch)
+{
+    int channels = input.getFormat().channels;
+    int blockFrames = batch.blockFrames;
+
+    scratch.resize(channels * blockFrames);
+    float *buffers[2];
+    for (int c = 0; c < channels; ++c)
+        buffers[c] = &scratch[c * blockFrames];
+
+    for (size_t offset = start; offset < end; offset += blockFrames) {
+        int frames = (int)std::min<size_t>(blockFrames, end - offset);
+        int inputFrames = (offset < input.getFrames()) ? (int)std::min<size_t>(frames, input.getFrames() - offset) : 0;
+
+        input.read(offset, buffers, inputFrames);
+        for (int c = 0; c < channels; ++c)
+            std::fill(buffers[c] + inputFrames, buffers[c] + blockFrames, 0.f);
+
+        process.process<float>(buffers, buffers, channels, channels, blockFrames);
+
+        output.write(offset, buffers, frames);
+    }
+}
+
+static void runWorker(Batch &batch)
+{
+    std::unique_ptr<RegraderProcess> process;
+    unsigned sampleRate = 0;
+    int channels = 0;
+    std::vector<float> scratch;
+
+    std::future<LoadedFile> next = loadNextFile(batch);
+
+    while (next.valid()) {
+        LoadedFile current = next.get();
+        next = loadNextFile(batch);
+
+        if (!current.error.empty()) {
+            fprintf(stderr, "%s\n", current.error.c_str());
+            ++batch.failures;
+            continue;
+        }
+
+        const WavReader &input = *current.reader;
+        const WavFormat &format = input.getFormat();
+        size_t outputFrames = getOutputFrames(batch, input);
+
+        WavWriter output;
+        std::string error;
+        if (!output.create(getOutputPath(batch, current.path).c_str(), format, outputFrames, error, &input)) {
+            fprintf(stderr, "%s\n", error.c_str());
+            ++batch.failures;
+            continue;
+        }
+
+        // the processor is only reconstructed when the format changes
+        if (process && format.sampleRate == sampleRate && format.channels == channels)
+            process->reset();
+        else {
+            sampleRate = format.sampleRate;
+            channels = format.channels;
+            process.reset(new RegraderProcess(channels, (float)sampleRate));
+            batch.model.apply(process.get());
+        }
+
+        renderFrames(batch, *process, input, output, 0, outputFrames, scratch);
+        finishOutput(batch, output);
+    }
+}
+
+static const int BANK_LANES = 8;
+
+// renders the files, which share their format, through a single bank. Lanes are
+// left out of the processing once their output is complete
+static void renderBank(Batch &batch, const std::vector<LoadedFile> &files)
+{
+    const WavFormat &format = files[0].reader->getFormat();
+    int channels = format.channels;
+    int blockFrames = batch.blockFrames;
+    int lanes = (int)files.size();
+
+    RegraderBank8 bank(channels, (float)format.sampleRate);
+
+    WavWriter outputs[BANK_LANES];
+    size_t outputFrames[BANK_LANES] = {};
+    bool created[BANK_LANES] = {};
+    size_t end = 0;
+
+    for (int l = 0; l < lanes; ++l) {
+        batch.model.apply(&bank, l);
+
+        std::string error;
+        created[l] = outputs[l].create(getOutputPath(batch, files[l].path).c_str(), format,
+                                       getOutputFrames(batch, *files[l].reader), error, files[l].reader.get());
+        if (!created[l]) {
+            fprintf(stderr, "%s\n", error.c_str());
+            ++batch.failures;
+            continue;
+        }
+        outputFrames[l] = getOutputFrames(batch, *files[l].reader);
+        end = std::max(end, outputFrames[l]);
+    }
+
+    std::vector<float> scratch(BANK_LANES * channels * blockFrames);
+    float *channelBuffers[BANK_LANES][2];
+    float **buffers[BANK_LANES];
+
+    for (int l = 0; l < BANK_LANES; ++l) {
+        for (int c = 0; c < channels; ++c)
+            channelBuffers[l][c] = &scratch[(l * channels + c) * blockFrames];
+    }
+
+    for (size_t offset = 0; offset < end; offset += blockFrames) {
+        for (int l = 0; l < BANK_LANES; ++l) {
+            buffers[l] = (offset < outputFrames[l]) ? channelBuffers[l] : nullptr;
+            if (!buffers[l])
+                continue;
+
+            const WavReader &input = *files[l].reader;
+            int inputFrames = (offset < input.getFrames()) ?
+                (int)std::min<size_t>(blockFrames, input.getFrames() - offset) : 0;
+
+            input.read(offset, buffers[l], inputFrames);
+            for (int c = 0; c < channels; ++c)
+                std::fill(buffers[l][c] + inputFrames, buffers[l][c] + blockFrames, 0.f);
+        }
+
+        bank.process<float>(buffers, buffers, blockFrames);
+
+        for (int l = 0; l < BANK_LANES; ++l) {
+            if (buffers[l])
+                outputs[l].write(offset, buffers[l], (int)std::min<size_t>(blockFrames, outputFrames[l] - offset));
+        }
+    }
+
+    for (int l = 0; l < lanes; ++l) {
+        if (created[l])
+            finishOutput(batch, outputs[l]);
+    }
+}
+
+static void runBankWorker(Batch &batch)
+{
+    std::future<LoadedFile> next = loadNextFile(batch);
+    LoadedFile carried; // the first file of the next group, when its format differs
+
+    while (carried.reader || next.valid()) {
+        std::vector<LoadedFile> files;
+        if (carried.reader)
+            files.push_back(std::move(carried));
+
+        while (files.size() < BANK_LANES && next.valid()) {
+            LoadedFile current = next.get();
+            next = loadNextFile(batch);
+
+            if (!current.error.empty()) {
+                fprintf(stderr, "%s\n", current.error.c_str());
+                ++batch.failures;
+                continue;
+            }
+
+            const WavFormat &format = current.reader->getFormat();
+            const WavFormat &groupFormat = files.empty() ? format : files[0].reader->getFormat();
+
+            if (format.sampleRate != groupFormat.sampleRate || format.channels != groupFormat.channels) {
+                carried = std::move(current);
+                break;
+            }
+            files.push_back(std::move(current));
+        }
+
+        if (!files.empty())
+            renderBank(batch, files);
+    }
+}
+
+// finds up to parts - 1 frames at which the input can be split, each the closest to
+// dividing the input evenly. These are the frames at the start of a block, preceded
+// by at least tail silent frames
+static std::vector<size_t> findSplitPoints(const WavReader &input, size_t tail, float silence, int parts,
+                                           size_t blockFrames)
+{
+    int channels = input.getFormat().channels;
+    size_t inputFrames = input.getFrames();
+
+    std::vector<float> scratch(channels * blockFrames);
+    float *buffers[2];
+    for (int c = 0; c < channels; ++c)
+        buffers[c] = &scratch[c * blockFrames];
+
+    // the ranges of frames which can be split at, both ends inclusive
+    std::vector<std::pair<size_t, size_t>> ranges;
+    size_t silentFrames = 0;
+
+    for (size_t offset = 0; offset + 1 < inputFrames; offset += blockFrames) {
+        int frames = (int)std::min(blockFrames, inputFrames - 1 - offset);
+        input.read(offset, buffers, frames);
+
+        for (int j = 0; j < frames; ++j) {
+            bool silent = true;
+            for (int c = 0; c < channels; ++c)
+                silent = silent && std::fabs(buffers[c][j]) <= silence;
+
+            silentFrames = silent ? silentFrames + 1 : 0;
+            if (silentFrames < std::max<size_t>(tail, 1))
+                continue;
+
+            size_t i = offset + j;
+            if (!ranges.empty() && ranges.back().second == i)
+                ranges.back().second = i + 1;
+            else
+                ranges.emplace_back(i + 1, i + 1);
+        }
+    }
+
+    std::vector<size_t> splits;
+    for (int k = 1; k < parts; ++k) {
+        size_t target = (inputFrames / parts * k + blockFrames / 2) / blockFrames * blockFrames;
+        size_t first = splits.empty() ? 1 : splits.back() + 1;
+        size_t best = 0, bestDistance = SIZE_MAX;
+
+        for (const std::pair<size_t, size_t> &range : ranges) {
+            size_t low = (std::max(range.first, first) + blockFrames - 1) / blockFrames * blockFrames;
+            size_t high = range.second / blockFrames * blockFrames;
+            if (low > high)
+                continue;
+            size_t point = std::min(std::max(target, low), high);
+            size_t distance = (point > target) ? point - target : target - point;
+            if (distance < bestDistance) {
+                best = point;
+                bestDistance = distance;
+            }
+        }
+
+        if (bestDistance != SIZE_MAX)
+            splits.push_back(best);
+    }
+
+    return splits;
+}
+
+static void renderPart(const Batch &batch, const WavReader &input, WavWriter &output, size_t start, size_t end)
+{
+    const WavFormat &format = input.getFormat();
+
+    RegraderProcess process(format.channels, (float)format.sampleRate);
+    batch.model.apply(&process);
+
+    for (size_t offset = 0; offset < start; offset += batch.blockFrames)
+        process.advance(format.channels, batch.blockFrames);
+
+    std::vector<float> scratch;
+    renderFrames(batch, process, input, output, start, end, scratch);
+}
+
+static void renderSplitFiles(Batch &batch)
+{
+    std::future<LoadedFile> next = loadNextFile(batch);
+
+    while (next.valid()) {
+        LoadedFile current = next.get();
+        next = loadNextFile(batch);
+
+        if (!current.error.empty()) {
+            fprintf(stderr, "%s\n", current.error.c_str());
+            ++batch.failures;
+            continue;
+        }
+
+        const WavReader &input = *current.reader;
+        const WavFormat &format = input.getFormat();
+        size_t outputFrames = getOutputFrames(batch, input);
+
+        WavWriter output;
+        std::string error;
+        if (!output.create(getOutputPath(batch, current.path).c_str(), format, outputFrames, error, &input)) {
+            fprintf(stderr, "%s\n", error.c_str());
+            ++batch.failures;
+            continue;
+        }
+
+        // the tail length depends on the settings and the sample rate
+        int tail;
+        {
+            RegraderProcess process(format.channels, (float)format.sampleRate);
+            batch.model.apply(&process);
+            tail = process.getTailLength(batch.silence);
+        }
+
+        std::vector<size_t> bounds;
+        if (tail >= 0)
+            bounds = findSplitPoints(input, tail, batch.silence, batch.jobs, batch.blockFrames);
+
+        bounds.insert(bounds.begin(), 0);
+        bounds.push_back(outputFrames);
+
+        std::vector<std::thread> parts;
+        for (size_t k = 1; k + 1 < bounds.size(); ++k)
+            parts.emplace_back(&renderPart, std::cref(batch), std::cref(input), std::ref(output), bounds[k],
+                               bounds[k + 1]);
+        renderPart(batch, input, output, bounds[0], bounds[1]);
+
+        for (std::thread &part : parts)
+            part.join();
+
+        finishOutput(batch, output);
+    }
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "Usage: regrader-render [options] -o <directory> <input.wav>...\n"
+            "  -o <directory>   directory the output files are written into, under the\n"
+            "                   names of the input files\n"
+            "  -j, --jobs <n>   amount of files rendered in parallel (default 1, 0 for\n"
+            "                   the amount of processors)\n"
+            "  -s, --split      render the files one at a time, each split into as many\n"
+            "                   parts as there are jobs at silences longer than the tail\n"
+            "  -B, --bank       render up to eight files of the same format at once, each\n"
+            "                   on a lane of a RegraderBank. The settings cannot use the\n"
+            "                   oscillators, flanger, in loop placement, lookahead, host\n"
+            "                   sync or filter types other than the 12 dB classic low pass\n"
+            "  -l <dB>          level below which the input is considered silent and the\n"
+            "                   tail decayed, when splitting (default -96)\n"
+            "  -b <frames>      frames per processing block (default 1024)\n"
+            "  -t <seconds>     length of silence processed after each file, to render the tail\n"
+            "  -p <id>=<value>  set the parameter with given index in paramids.h to a\n"
+            "                   normalized value in the 0 - 1 range (repeatable)\n"
+            "\n"
+            "Input files are WAVE or RF64, mono or stereo with 16, 24 or 32-bit integer\n"
+            "or 32 or 64-bit float samples, the output files have the format of their input.\n");
+}
+
+int main(int argc, char *argv[])
+{
+    Batch batch;
+
+    static const option longOptions[] = {
+        {"jobs", required_argument, nullptr, 'j'},
+        {"split", no_argument, nullptr, 's'},
+        {"bank", no_argument, nullptr, 'B'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    for (int c; (c = getopt_long(argc, argv, "o:j:sBl:b:t:p:h", longOptions, nullptr)) != -1;) {
+        switch (c) {
+        case 'o': batch.outputDirectory = optarg; break;
+        case 'j': batch.jobs = atoi(optarg); break;
+        case 's': batch.split = true; break;
+        case 'B': batch.bank = true; break;
+        case 'l': batch.silence = (float)pow(10.0, atof(optarg) / 20); break;
+        case 'b': batch.blockFrames = atoi(optarg); break;
+        case 't': batch.tailSeconds = atof(optarg); break;
+        case 'p':
+            if (!parseParameter(optarg, batch.model))
+                return 2;
+            break;
+        default: usage(); return (c == 'h') ? 0 : 2;
+        }
+    }
+
+    batch.inputs.assign(argv + optind, argv + argc);
+
+    if (batch.inputs.empty() || batch.outputDirectory.empty() || batch.jobs < 0 || batch.blockFrames < 1 ||
+        batch.tailSeconds < 0 || !(batch.silence > 0 && batch.silence < 1) || (batch.split && batch.bank)) {
+        usage();
+        return 2;
+    }
+
+    if (batch.bank && !batch.model.fitsBank()) {
+        fprintf(stderr, "The parameters use effects a RegraderBank does not provide, see --bank\n");
+        return 2;
+    }
+
+    if (batch.jobs == 0)
+        batch.jobs = std::max(1u, std::thread::hardware_concurrency());
+
+    if (batch.split)
+        renderSplitFiles(batch);
+    else {
+        // a bank worker renders up to BANK_LANES files at once
+        size_t filesPerWorker = batch.bank ? BANK_LANES : 1;
+        int workerCount = (int)std::min<size_t>(batch.jobs, (batch.inputs.size() + filesPerWorker - 1) / filesPerWorker);
+
+        void (*run)(Batch &) = batch.bank ? &runBankWorker : &runWorker;
+
+        std::vector<std::thread> workers;
+        for (int i = 1; i < workerCount; ++i)
+            workers.emplace_back(run, std::ref(batch));
+        run(batch);
+
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    return batch.failures ? 1 : 0;
+}
@@ -0,0 +1,268 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// processes raw interleaved PCM read from the standard input and writes the
+// result onto the standard output, for use in shell pipelines
+//
+// reading, processing and writing run on their own threads, passing two input
+// and two output blocks between them, so the I/O overlaps with the processing
+
+#include "regraderprocess.h"
+#include "regradermodel.h"
+#include "parameters.h"
+#include "sampleconvert.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <unistd.h>
+
+using namespace Igorski;
+
+enum SampleFormat { kFormatFloat32, kFormatInt16 };
+
+struct Block
+{
+    std::vector<char> data; // interleaved samples
+    size_t frames = 0;
+    bool last = false;      // whether this is the last block of the stream
+};
+
+// blocking queue of blocks passed from one thread to another
+class BlockQueue
+{
+public:
+    void push(Block *block)
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fBlocks.push_back(block);
+        fCondition.notify_one();
+    }
+
+    Block *pop()
+    {
+        std::unique_lock<std::mutex> lock(fMutex);
+        fCondition.wait(lock, [this]() { return !fBlocks.empty(); });
+        Block *block = fBlocks.front();
+        fBlocks.pop_front();
+        return block;
+    }
+
+private:
+    std::mutex fMutex;
+    std::condition_variable fCondition;
+    std::deque<Block *> fBlocks;
+};
+
+struct Stream
+{
+    SampleFormat format = kFormatFloat32;
+    int channels = 2;
+    int blockFrames = 1024;
+    float sampleRate = 48000;
+    double tailSeconds = 0;
+
+    size_t frameBytes() const { return channels * (format == kFormatInt16 ? sizeof(int16) : sizeof(float)); }
+
+    BlockQueue inputFree, inputFilled, outputFree, outputFilled;
+    std::atomic<bool> failed{false};
+};
+
+static void readInput(Stream &s)
+{
+    size_t frameBytes = s.frameBytes();
+    uint64_t tailFrames = (uint64_t)(s.tailSeconds * s.sampleRate);
+    bool endOfInput = false;
+
+    for (bool last = false; !last;) {
+        Block *block = s.inputFree.pop();
+        size_t capacity = block->data.size();
+
+        // stop reading once the output has failed
+        if (s.failed)
+            endOfInput = true;
+
+        size_t bytes = 0;
+        if (!endOfInput) {
+            bytes = fread(block->data.data(), 1, capacity, stdin);
+            if (bytes < capacity) {
+                if (ferror(stdin)) {
+                    fprintf(stderr, "Cannot read the standard input\n");
+                    s.failed = true;
+                }
+                endOfInput = true;
+            }
+        }
+
+        // a trailing partial frame is dropped
+        block->frames = bytes / frameBytes;
+
+        // once the input has ended, append silence for the tail of the delay
+        if (endOfInput && !s.failed && block->frames < (size_t)s.blockFrames && tailFrames > 0) {
+            size_t silence = std::min<uint64_t>(tailFrames, s.blockFrames - block->frames);
+            memset(&block->data[block->frames * frameBytes], 0, silence * frameBytes);
+            block->frames += silence;
+            tailFrames -= silence;
+        }
+
+        last = endOfInput && (tailFrames == 0 || s.failed);
+        block->last = last;
+        s.inputFilled.push(block);
+    }
+}
+
+static void processBlocks(Stream &s, RegraderProcess &process)
+{
+    int channels = s.channels;
+    std::vector<float> samples(channels * s.blockFrames);
+
+    for (bool last = false; !last;) {
+        Block *in = s.inputFilled.pop();
+        Block *out = s.outputFree.pop();
+        int frames = (int)in->frames;
+
+        // the processor consumes and produces the interleaved frames directly,
+        // 16-bit integer frames are converted to floats around it, rounding the same
+        // way as the files written by regrader-render
+        if (frames > 0 && s.format == kFormatInt16) {
+            float *buffer = samples.data();
+            SampleConvert::int16LEToFloat((const uint8 *)in->data.data(), 1, &buffer, frames * channels);
+
+            process.process<float>(buffer, buffer, channels, frames);
+
+            SampleConvert::floatToInt16LE(&buffer, 1, (uint8 *)out->data.data(), frames * channels);
+        }
+        else if (frames > 0)
+            process.process<float>((const float *)in->data.data(), (float *)out->data.data(), channels, frames);
+
+        out->frames = in->frames;
+        out->last = last = in->last;
+        s.inputFree.push(in);
+        s.outputFilled.push(out);
+    }
+}
+
+static void writeOutput(Stream &s)
+{
+    size_t frameBytes = s.frameBytes();
+
+    for (bool last = false; !last;) {
+        Block *block = s.outputFilled.pop();
+        size_t bytes = block->frames * frameBytes;
+
+        // upon failure keep consuming the blocks, until the reader stops
+        if (!s.failed && (fwrite(block->data.data(), 1, bytes, stdout) != bytes || fflush(stdout) != 0)) {
+            fprintf(stderr, "Cannot write the standard output\n");
+            s.failed = true;
+        }
+
+        last = block->last;
+        s.outputFree.push(block);
+    }
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "Usage: regrader-stream [options] < input.pcm > output.pcm\n"
+            "  -f <format>    sample format, f32 or s16 (default f32)\n"
+            "  -c <channels>  amount of interleaved channels, 1 or 2 (default 2)\n"
+            "  -r <rate>      sample rate in Hz (default 48000)\n"
+            "  -b <frames>    frames per processing block (default 1024)\n"
+            "  -t <seconds>   length of silence processed after the input, to render the tail\n"
+            "  -p <id>=<value>  set the parameter with given index in paramids.h to a\n"
+            "                 normalized value in the 0 - 1 range (repeatable)\n"
+            "\n"
+            "Samples are in native byte order.\n");
+}
+
+int main(int argc, char *argv[])
+{
+    Stream s;
+    RegraderModel model;
+
+    for (int c; (c = getopt(argc, argv, "f:c:r:b:t:p:h")) != -1;) {
+        switch (c) {
+        case 'f':
+            if (!strcmp(optarg, "f32"))
+                s.format = kFormatFloat32;
+            else if (!strcmp(optarg, "s16"))
+                s.format = kFormatInt16;
+            else {
+                usage();
+                return 2;
+            }
+            break;
+        case 'c': s.channels = atoi(optarg); break;
+        case 'r': s.sampleRate = (float)atof(optarg); break;
+        case 'b': s.blockFrames = atoi(optarg); break;
+        case 't': s.tailSeconds = atof(optarg); break;
+        case 'p':
+            if (!parseParameter(optarg, model))
+                return 2;
+            break;
+        default: usage(); return (c == 'h') ? 0 : 2;
+        }
+    }
+
+    if (optind != argc || s.channels < 1 || s.channels > 2 || s.sampleRate < 1 ||
+        s.blockFrames < 1 || s.tailSeconds < 0) {
+        usage();
+        return 2;
+    }
+
+    if (isatty(STDOUT_FILENO)) {
+        fprintf(stderr, "Refusing to write binary samples onto a terminal\n");
+        return 2;
+    }
+
+    // report a closed output as a write error rather than terminating
+    signal(SIGPIPE, SIG_IGN);
+
+    RegraderProcess process(s.channels, s.sampleRate);
+    model.apply(&process);
+
+    Block blocks[4];
+    for (Block &block : blocks)
+        block.data.resize(s.blockFrames * s.frameBytes());
+
+    s.inputFree.push(&blocks[0]);
+    s.inputFree.push(&blocks[1]);
+    s.outputFree.push(&blocks[2]);
+    s.outputFree.push(&blocks[3]);
+
+    std::thread reader(&readInput, std::ref(s));
+    std::thread writer(&writeOutput, std::ref(s));
+    processBlocks(s, process);
+
+    reader.join();
+    writer.join();
+
+    return s.failed ? 1 : 0;
+}
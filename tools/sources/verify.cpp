@@ -0,0 +1,797 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// renders deterministic signals through the processors and either stores the
+// output as a reference (golden) file, or compares the output against a reference
+// file written by another build, e.g. before and after optimizing a processor
+
+#include "bitcrusher.h"
+#include "calc.h"
+#include "decimator.h"
+#include "filter.h"
+#include "flanger.h"
+#include "limiter.h"
+#include "regraderbank.h"
+#include "regraderprocess.h"
+#include "regradermodel.h"
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+using namespace Igorski;
+
+struct FILE_deleter { void operator()(FILE *x) const noexcept { fclose(x); } };
+typedef std::unique_ptr<FILE, FILE_deleter> FILE_u;
+
+// planar stereo buffer, the left channel followed by the right channel
+typedef std::vector<float> Buffer;
+
+typedef std::function<void(float *channels[2], int frames)> BlockFunction;
+
+struct Case
+{
+    const char *name;
+    // the maximum error relative to the reference, as the level of the
+    // difference signal relative to the reference signal
+    double toleranceDb;
+    // an output within this distance of the reference in units in the last
+    // place passes regardless of the level of the difference
+    uint32_t toleranceUlp;
+    std::function<BlockFunction(float sampleRate)> create;
+};
+
+struct Signal
+{
+    const char *name;
+    void (*generate)(Buffer &buffer, int frames, float sampleRate);
+};
+
+// -----------------------------------------------------------------------
+// Signals
+
+static uint32_t xorshift(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static void generateImpulses(Buffer &buffer, int frames, float sampleRate)
+{
+    // an impulse every half second, the right channel lagging a quarter second
+    int interval = (int)(sampleRate / 2);
+    for (int i = 0; i < frames; i += interval) {
+        buffer[i] = 1.f;
+        if (i + interval / 2 < frames)
+            buffer[frames + i + interval / 2] = -1.f;
+    }
+}
+
+static void generateSweep(Buffer &buffer, int frames, float sampleRate)
+{
+    // logarithmic sine sweep from 20 Hz to 20 kHz
+    double f1 = 20, f2 = std::min(20000.0, 0.45 * sampleRate);
+    double duration = frames / (double)sampleRate;
+    double k = std::log(f2 / f1);
+    for (int i = 0; i < frames; ++i) {
+        double t = i / (double)sampleRate;
+        double phase = 2 * M_PI * f1 * duration / k * (std::exp(t / duration * k) - 1);
+        buffer[i] = (float)(0.8 * std::sin(phase));
+        buffer[frames + i] = (float)(0.5 * std::sin(phase));
+    }
+}
+
+static void generateNoise(Buffer &buffer, int frames, float)
+{
+    uint32_t state = 0x2545f491;
+    for (int i = 0; i < 2 * frames; ++i)
+        buffer[i] = (xorshift(state) >> 8) * (2.f / 16777216.f) - 1.f;
+}
+
+static const Signal signals[] = {
+    { "impulses", &generateImpulses },
+    { "sweep", &generateSweep },
+    { "noise", &generateNoise },
+};
+
+// -----------------------------------------------------------------------
+// Cases
+
+// divides the frames into blocks of varying size, so the results
+// also cover the handling of block boundaries
+static void forEachBlock(int frames, const std::function<void(int offset, int size)> &process)
+{
+    static const int blockSizes[] = { 256, 64, 1, 511, 128, 32 };
+    const int numBlockSizes = sizeof(blockSizes) / sizeof(blockSizes[0]);
+
+    for (int offset = 0, block = 0; offset < frames; ++block) {
+        int size = std::min(frames - offset, blockSizes[block % numBlockSizes]);
+        process(offset, size);
+        offset += size;
+    }
+}
+
+static void processBlocks(Buffer &buffer, int frames, const BlockFunction &process)
+{
+    forEachBlock(frames, [&buffer, frames, &process](int offset, int size) {
+        float *channels[2] = { &buffer[offset], &buffer[frames + offset] };
+        process(channels, size);
+    });
+}
+
+static BlockFunction createBitCrusher(float sampleRate, bool withLFO)
+{
+    std::shared_ptr<BitCrusher> bitCrusher(new BitCrusher(8, .5f, .5f, sampleRate));
+    bitCrusher->setAmount(.4f);
+    if (withLFO)
+        bitCrusher->setLFO(.5f, .75f);
+
+    return [bitCrusher](float *channels[2], int frames) {
+        for (int c = 0; c < 2; ++c)
+            bitCrusher->process(channels[c], frames);
+    };
+}
+
+static BlockFunction createDecimator(float)
+{
+    std::shared_ptr<Decimator> decimator(new Decimator(32, 0.f));
+    decimator->setBits(6);
+    decimator->setRate(.3f);
+
+    return [decimator](float *channels[2], int frames) {
+        decimator->store();
+        decimator->process(channels[0], frames);
+        decimator->restore();
+        decimator->process(channels[1], frames);
+    };
+}
+
+static BlockFunction createFilter(float sampleRate, bool withLFO, int type = Filter::kClassicLowPass,
+                                  int slope = Filter::kSlope12dB)
+{
+    std::shared_ptr<Filter> filter(new Filter(sampleRate));
+    filter->setType(type);
+    filter->setSlope(slope);
+    if (withLFO)
+        filter->updateProperties(.5f, .7f, .5f, .8f);
+    else
+        filter->updateProperties(.3f, .8f, 0.f, .5f);
+
+    return [filter](float *channels[2], int frames) {
+        filter->store();
+        filter->process(channels[0], frames, 0);
+        filter->restore();
+        filter->process(channels[1], frames, 1);
+    };
+}
+
+static BlockFunction createFlanger(float sampleRate)
+{
+    std::shared_ptr<Flanger> flanger(new Flanger(2, sampleRate));
+    flanger->setRate(.4f);
+    flanger->setWidth(.7f);
+    flanger->setFeedback(.5f);
+    flanger->setDelay(.3f);
+
+    return [flanger](float *channels[2], int frames) {
+        flanger->store();
+        flanger->process(channels[0], frames, 0);
+        flanger->restore();
+        flanger->process(channels[1], frames, 1);
+    };
+}
+
+static BlockFunction createLimiter(float)
+{
+    std::shared_ptr<Limiter> limiter(new Limiter(10.f, 500.f, .6f));
+
+    return [limiter](float *channels[2], int frames) {
+        // drive the limiter well over its threshold
+        for (int c = 0; c < 2; ++c) {
+            for (int i = 0; i < frames; ++i)
+                channels[c][i] *= 4.f;
+        }
+        limiter->process<float>(channels, frames, 2);
+    };
+}
+
+static BlockFunction createLookaheadLimiter(float sampleRate)
+{
+    std::shared_ptr<Limiter> limiter(new Limiter(10.f, 500.f, .6f));
+    limiter->prepareLookahead((int)(sampleRate * .005f), 2, sampleRate);
+    limiter->setLookahead((int)(sampleRate * .002f));
+    limiter->setCeiling(-1.f);
+
+    return [limiter](float *channels[2], int frames) {
+        for (int c = 0; c < 2; ++c) {
+            for (int i = 0; i < frames; ++i)
+                channels[c][i] *= 4.f;
+        }
+        limiter->process<float>(channels, frames, 2);
+    };
+}
+
+// the complete processor, with the parameters applied the same way as the plugin does
+static BlockFunction createChain(float sampleRate, const std::vector<std::pair<int, float>> &values,
+                                 int controlInterval = 1)
+{
+    std::shared_ptr<RegraderProcess> process(new RegraderProcess(2, sampleRate));
+    process->setControlInterval(controlInterval);
+    RegraderModel model;
+    for (const std::pair<int, float> &value : values)
+        model.setValue(value.first, value.second);
+    model.apply(process.get());
+
+    return [process](float *channels[2], int frames) {
+        process->setTempo(120.0, 4, 4);
+        process->process<float>(channels, channels, 2, 2, frames);
+    };
+}
+
+static const Case cases[] = {
+    // the quantizing processors can flip a step upon the slightest
+    // difference of their input, hence the looser tolerances
+    { "bitcrusher", -60, 4, [](float sr) { return createBitCrusher(sr, false); } },
+    { "bitcrusher-lfo", -60, 4, [](float sr) { return createBitCrusher(sr, true); } },
+    { "decimator", -60, 4, [](float sr) { return createDecimator(sr); } },
+    { "filter", -90, 4, [](float sr) { return createFilter(sr, false); } },
+    { "filter-lfo", -90, 4, [](float sr) { return createFilter(sr, true); } },
+    { "filter-svf-highpass", -90, 4, [](float sr) { return createFilter(sr, false, Filter::kHighPass); } },
+    { "filter-svf-lowpass-lfo", -90, 4, [](float sr) { return createFilter(sr, true, Filter::kLowPass); } },
+    { "filter-svf-bandpass-lfo", -90, 4, [](float sr) { return createFilter(sr, true, Filter::kBandPass); } },
+    { "filter-24db-highpass", -90, 4, [](float sr) { return createFilter(sr, false, Filter::kHighPass, Filter::kSlope24dB); } },
+    { "filter-48db-lowpass-lfo", -90, 4, [](float sr) { return createFilter(sr, true, Filter::kLowPass, Filter::kSlope48dB); } },
+    // the sweep of the flanger reverses upon crossing its bounds, a rounding difference
+    // (e.g. from contracting into fused multiply-adds) can move a reversal by a sample,
+    // which offsets the sweep for the remainder of the signal
+    { "flanger", -90, 4, [](float sr) { return createFlanger(sr); } },
+    { "limiter", -90, 4, [](float sr) { return createLimiter(sr); } },
+    { "limiter-lookahead", -90, 4, [](float sr) { return createLookaheadLimiter(sr); } },
+    { "chain-default", -90, 4, [](float sr) {
+        return createChain(sr, {});
+    } },
+    { "chain-delay", -90, 4, [](float sr) {
+        return createChain(sr, {
+            { kDelayHostSyncId, 0.f }, { kDelayTimeId, .1f }, { kDelayFeedbackId, .7f }, { kDelayMixId, .6f },
+        });
+    } },
+    { "chain-postmix", -60, 4, [](float sr) {
+        return createChain(sr, {
+            { kDelayHostSyncId, 0.f }, { kDelayTimeId, .05f }, { kDelayFeedbackId, .5f },
+            { kBitResolutionId, .5f }, { kBitResolutionChainId, 1.f }, { kLFOBitResolutionId, .3f },
+            { kDecimatorId, .4f }, { kDecimatorChainId, 1.f }, { kLFODecimatorId, .2f },
+            { kFilterChainId, 1.f }, { kFilterCutoffId, .4f }, { kLFOFilterId, .3f },
+            { kFlangerChainId, 1.f }, { kFlangerRateId, .3f }, { kFlangerWidthId, .6f }, { kFlangerFeedbackId, .4f },
+        });
+    } },
+    { "chain-inloop", -60, 4, [](float sr) {
+        return createChain(sr, {
+            { kDelayHostSyncId, 0.f }, { kDelayTimeId, .02f }, { kDelayFeedbackId, .8f },
+            { kBitResolutionId, .6f }, { kBitResolutionLoopId, 1.f },
+            { kDecimatorId, .5f }, { kDecimatorLoopId, 1.f }, { kLFODecimatorId, .4f },
+            { kFilterLoopId, 1.f }, { kFilterCutoffId, .6f }, { kLFOFilterId, .5f },
+        });
+    } },
+    { "chain-control-rate", -60, 4, [](float sr) {
+        // the oscillators read every 32 samples, in the loop and after it
+        return createChain(sr, {
+            { kDelayHostSyncId, 0.f }, { kDelayTimeId, .03f }, { kDelayFeedbackId, .6f },
+            { kBitResolutionId, .5f }, { kBitResolutionLoopId, 1.f }, { kLFOBitResolutionId, .4f },
+            { kFilterChainId, 1.f }, { kFilterCutoffId, .4f }, { kLFOFilterId, .6f }, { kFilterTypeId, 1.f },
+            { kFlangerChainId, 1.f }, { kFlangerRateId, .5f }, { kFlangerWidthId, .6f }, { kFlangerFeedbackId, .4f },
+        }, 32);
+    } },
+    { "chain-lfo-shapes", -60, 4, [](float sr) {
+        // a square wave moving the crusher and sample and hold moving the filter
+        return createChain(sr, {
+            { kDelayHostSyncId, 0.f }, { kDelayTimeId, .04f }, { kDelayFeedbackId, .5f },
+            { kBitResolutionId, .5f }, { kLFOBitResolutionId, .6f }, { kLFOBitResolutionShapeId, .75f },
+            { kFilterChainId, 1.f }, { kFilterCutoffId, .4f }, { kLFOFilterId, .8f }, { kLFOFilterShapeId, 1.f },
+        });
+    } },
+    { "chain-compact", -60, 4, [](float sr) {
+        // a pre mix bit resolution low enough to store the delay memory as integers
+        return createChain(sr, {
+            { kDelayHostSyncId, 0.f }, { kDelayTimeId, .08f }, { kDelayFeedbackId, .6f },
+            { kBitResolutionId, .3f }, { kBitResolutionChainId, 0.f },
+        });
+    } },
+};
+
+// -----------------------------------------------------------------------
+// Reference files
+
+// a reference file contains, in native byte order:
+//   "RGRF", uint32 version, float sample rate, uint32 frames, uint32 amount of renders
+// followed by each render as:
+//   uint32 length of the name, the name, frames * 2 floats (planar stereo)
+
+static const char referenceMagic[4] = { 'R', 'G', 'R', 'F' };
+static const uint32_t referenceVersion = 1;
+
+struct Render
+{
+    std::string name;
+    const Case *testCase;
+    Buffer output;
+};
+
+static std::vector<Render> renderAll(float sampleRate, int frames, const char *filter)
+{
+    std::vector<Render> renders;
+
+    for (const Case &testCase : cases) {
+        for (const Signal &signal : signals) {
+            std::string name = std::string(testCase.name) + "/" + signal.name;
+            if (filter && name.find(filter) == std::string::npos)
+                continue;
+
+            Render render;
+            render.name = name;
+            render.testCase = &testCase;
+            render.output.assign(2 * frames, 0.f);
+            signal.generate(render.output, frames, sampleRate);
+            processBlocks(render.output, frames, testCase.create(sampleRate));
+            renders.push_back(std::move(render));
+        }
+    }
+
+    return renders;
+}
+
+static bool writeReference(const char *path, float sampleRate, int frames, const std::vector<Render> &renders)
+{
+    FILE_u file(fopen(path, "wb"));
+    if (!file) {
+        fprintf(stderr, "Cannot open %s for writing\n", path);
+        return false;
+    }
+
+    uint32_t header[4] = { referenceVersion, 0, (uint32_t)frames, (uint32_t)renders.size() };
+    memcpy(&header[1], &sampleRate, sizeof(float));
+
+    bool ok = fwrite(referenceMagic, 4, 1, file.get()) == 1 &&
+        fwrite(header, sizeof(header), 1, file.get()) == 1;
+
+    for (size_t i = 0; ok && i < renders.size(); ++i) {
+        const Render &render = renders[i];
+        uint32_t length = (uint32_t)render.name.size();
+        ok = fwrite(&length, sizeof(length), 1, file.get()) == 1 &&
+            fwrite(render.name.data(), length, 1, file.get()) == 1 &&
+            fwrite(render.output.data(), sizeof(float), render.output.size(), file.get()) == render.output.size();
+    }
+
+    if (!ok || fflush(file.get()) != 0) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return false;
+    }
+
+    return true;
+}
+
+static bool readReference(const char *path, float &sampleRate, int &frames, std::vector<Render> &renders)
+{
+    FILE_u file(fopen(path, "rb"));
+    if (!file) {
+        fprintf(stderr, "Cannot open %s for reading\n", path);
+        return false;
+    }
+
+    char magic[4];
+    uint32_t header[4];
+    if (fread(magic, 4, 1, file.get()) != 1 || memcmp(magic, referenceMagic, 4) != 0 ||
+        fread(header, sizeof(header), 1, file.get()) != 1 || header[0] != referenceVersion) {
+        fprintf(stderr, "%s is not a reference file of this version\n", path);
+        return false;
+    }
+
+    memcpy(&sampleRate, &header[1], sizeof(float));
+    frames = (int)header[2];
+
+    renders.resize(header[3]);
+    for (Render &render : renders) {
+        uint32_t length;
+        bool ok = fread(&length, sizeof(length), 1, file.get()) == 1 && length < 256;
+        if (ok) {
+            render.name.resize(length);
+            render.output.resize(2 * frames);
+            render.testCase = nullptr;
+            ok = fread(&render.name[0], length, 1, file.get()) == 1 &&
+                fread(render.output.data(), sizeof(float), render.output.size(), file.get()) == render.output.size();
+        }
+        if (!ok) {
+            fprintf(stderr, "%s is truncated\n", path);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------
+// Comparison
+
+// distance between two floats in units in the last place
+static uint32_t ulpDistance(float a, float b)
+{
+    int32_t ia, ib;
+    memcpy(&ia, &a, sizeof(float));
+    memcpy(&ib, &b, sizeof(float));
+
+    // map the sign-magnitude representation onto a monotonic integer scale
+    int64_t la = (ia < 0) ? (int64_t)INT32_MIN - ia : ia;
+    int64_t lb = (ib < 0) ? (int64_t)INT32_MIN - ib : ib;
+
+    return (uint32_t)std::min<int64_t>(std::llabs(la - lb), UINT32_MAX);
+}
+
+static bool compare(const Render &render, const Buffer &reference)
+{
+    const Buffer &output = render.output;
+
+    uint32_t maxUlp = 0;
+    double maxError = 0;
+    double referencePower = 0, errorPower = 0;
+    bool finite = true;
+
+    for (size_t i = 0; i < output.size(); ++i) {
+        if (!std::isfinite(output[i]))
+            finite = false;
+        double error = (double)output[i] - (double)reference[i];
+        referencePower += (double)reference[i] * reference[i];
+        errorPower += error * error;
+        maxError = std::max(maxError, std::fabs(error));
+        maxUlp = std::max(maxUlp, ulpDistance(output[i], reference[i]));
+    }
+
+    double errorDb = (errorPower > 0) ?
+        10 * std::log10(errorPower / std::max(referencePower, 1e-30)) : -HUGE_VAL;
+
+    const Case &testCase = *render.testCase;
+    bool pass = finite && (maxUlp <= testCase.toleranceUlp || errorDb <= testCase.toleranceDb);
+
+    printf("%-4s %-28s %10u ulp %8.1f dB (max %.3g, tolerance %g dB)\n",
+           pass ? "ok" : "FAIL", render.name.c_str(), maxUlp, errorDb, maxError, testCase.toleranceDb);
+
+    return pass;
+}
+
+// -----------------------------------------------------------------------
+// Accuracy of the approximations in Calc::Fast
+
+struct Approximation
+{
+    const char *name;
+    // the domain over which the error bound holds
+    float lower;
+    float upper;
+    // the documented error bound, relative to the exact value when relative is set
+    double bound;
+    bool relative;
+    // whether arguments below the domain give 0, as the C library underflows
+    bool underflows;
+    std::function<float(float)> approximate;
+    std::function<double(double)> exact;
+    // the array version, which has to give the same values as the scalar version
+    std::function<void(const float *in, float *out, int amount)> array;
+};
+
+static float fastSine(float x) { float s, c; Calc::Fast::sinCos(x, s, c); return s; }
+static float fastCosine(float x) { float s, c; Calc::Fast::sinCos(x, s, c); return c; }
+
+static const Approximation approximations[] = {
+    {"floor", -16777216.f, 16777216.f, 0, false, false,
+     [](float x) { return Calc::Fast::floor(x); },
+     [](double x) { return std::floor(x); },
+     [](const float *in, float *out, int amount) { Calc::Fast::floor(in, out, amount); }},
+    {"exp", -87.3f, 88.3f, 2e-7, true, true,
+     [](float x) { return Calc::Fast::exp(x); },
+     [](double x) { return std::exp(x); },
+     [](const float *in, float *out, int amount) { Calc::Fast::exp(in, out, amount); }},
+    {"pow10", -37.9f, 38.3f, 2e-7, true, true,
+     [](float x) { return Calc::Fast::pow10(x); },
+     [](double x) { return std::pow(10.0, x); },
+     [](const float *in, float *out, int amount) { Calc::Fast::pow10(in, out, amount); }},
+    {"tanPi", 0.f, .4999f, 5e-7, true, false,
+     [](float x) { return Calc::Fast::tanPi(x); },
+     [](double x) { return std::tan(M_PI * x); },
+     [](const float *in, float *out, int amount) { Calc::Fast::tanPi(in, out, amount); }},
+    {"sin", -8 * VST::PI, 8 * VST::PI, 1.5e-7, false, false,
+     fastSine,
+     [](double x) { return std::sin(x); },
+     [](const float *in, float *out, int amount) {
+         std::vector<float> cosines(amount);
+         Calc::Fast::sinCos(in, out, cosines.data(), amount);
+     }},
+    {"cos", -8 * VST::PI, 8 * VST::PI, 1.5e-7, false, false,
+     fastCosine,
+     [](double x) { return std::cos(x); },
+     [](const float *in, float *out, int amount) {
+         std::vector<float> sines(amount);
+         Calc::Fast::sinCos(in, sines.data(), out, amount);
+     }},
+};
+
+// evaluates the approximation over evenly spaced points of its domain
+static bool checkAccuracy(const Approximation &approximation, int points)
+{
+    std::vector<float> arguments(points);
+    for (int i = 0; i < points; ++i) {
+        double position = (double)i / (points - 1);
+        arguments[i] = (float)(approximation.lower + position * ((double)approximation.upper - approximation.lower));
+    }
+
+    std::vector<float> values(points);
+    approximation.array(arguments.data(), values.data(), points);
+
+    double maxError = 0;
+    float maxArgument = arguments[0];
+    unsigned mismatches = 0;
+
+    for (int i = 0; i < points; ++i) {
+        float value = approximation.approximate(arguments[i]);
+        double exact = approximation.exact(arguments[i]);
+        double error = std::fabs(value - exact);
+
+        if (approximation.relative && exact != 0)
+            error /= std::fabs(exact);
+
+        // NaN fails the comparison below
+        if (!(error <= maxError)) {
+            maxError = error;
+            maxArgument = arguments[i];
+        }
+        if (memcmp(&value, &values[i], sizeof(float)) != 0)
+            ++mismatches;
+    }
+
+    unsigned nonZero = 0;
+
+    if (approximation.underflows) {
+        float below[] = { std::nextafter(approximation.lower, -INFINITY), approximation.lower - 1.f, -1e30f, -INFINITY };
+        const int numBelow = sizeof(below) / sizeof(below[0]);
+        float belowValues[numBelow];
+        approximation.array(below, belowValues, numBelow);
+
+        for (int i = 0; i < numBelow; ++i) {
+            if (approximation.approximate(below[i]) != 0.f || belowValues[i] != 0.f)
+                ++nonZero;
+        }
+    }
+
+    bool pass = maxError <= approximation.bound && mismatches == 0 && nonZero == 0;
+
+    printf("%-4s %-6s %s error %.3g at %.9g (bound %g), %u array values differ",
+           pass ? "ok" : "FAIL", approximation.name, approximation.relative ? "relative" : "absolute",
+           maxError, maxArgument, approximation.bound, mismatches);
+    if (approximation.underflows)
+        printf(", %u values below the domain are not 0", nonZero);
+    printf("\n");
+
+    return pass;
+}
+
+// -----------------------------------------------------------------------
+// Agreement of the RegraderBank lanes with the RegraderProcess
+
+typedef std::vector<std::pair<int, float>> Values;
+
+// the settings of the lanes, which only use the effects the bank provides
+static const Values bankLanes[8] = {
+    { { kDelayHostSyncId, 0.f }, { kDelayTimeId, .1f }, { kDelayFeedbackId, .7f }, { kDelayMixId, .6f } },
+    { { kDelayHostSyncId, 0.f }, { kDelayTimeId, .08f }, { kDelayFeedbackId, .6f },
+      { kBitResolutionId, .3f }, { kBitResolutionChainId, 0.f } },
+    { { kDelayHostSyncId, 0.f }, { kDelayTimeId, .05f }, { kDelayFeedbackId, .5f },
+      { kBitResolutionId, .5f }, { kDecimatorId, .4f }, { kLFODecimatorId, .2f } },
+    { { kDelayHostSyncId, 0.f }, { kDelayTimeId, .03f }, { kDelayFeedbackId, .4f },
+      { kDecimatorId, .2f }, { kDecimatorChainId, 1.f }, { kLFODecimatorId, .5f },
+      { kFilterChainId, 0.f }, { kFilterCutoffId, .3f }, { kFilterResonanceId, .8f } },
+    { { kDelayHostSyncId, 0.f }, { kDelayTimeId, .02f }, { kDelayFeedbackId, .8f }, { kFilterCutoffId, .4f } },
+    { { kDelayHostSyncId, 0.f }, { kDelayTimeId, .15f }, { kDelayFeedbackId, .3f }, { kDelayMixId, .9f },
+      { kBitResolutionId, .6f }, { kFilterCutoffId, .2f }, { kFilterResonanceId, .3f } },
+    { { kDelayHostSyncId, 0.f }, { kDelayTimeId, .001f }, { kDelayFeedbackId, .9f }, { kDelayMixId, .2f } },
+    { { kDelayHostSyncId, 0.f }, { kDelayTimeId, .04f }, { kDelayFeedbackId, .5f }, { kDelayMixId, 1.f },
+      { kBitResolutionId, .2f }, { kBitResolutionChainId, 0.f }, { kDecimatorId, .3f }, { kLFODecimatorId, .1f } },
+};
+
+// renders the signals through the lanes of a bank and through a processor per lane with
+// the same settings, the bank is expected to give the same output up to rounding
+static bool checkBank(float sampleRate, int frames, double tolerance)
+{
+    const int lanes = sizeof(bankLanes) / sizeof(bankLanes[0]);
+    unsigned failures = 0;
+
+    RegraderModel models[lanes];
+    for (int l = 0; l < lanes; ++l) {
+        for (const std::pair<int, float> &value : bankLanes[l])
+            models[l].setValue(value.first, value.second);
+        if (!models[l].fitsBank()) {
+            printf("%-4s lane %d uses effects the bank does not provide\n", "FAIL", l);
+            return false;
+        }
+    }
+
+    for (const Signal &signal : signals) {
+        Buffer input(2 * frames, 0.f);
+        signal.generate(input, frames, sampleRate);
+
+        RegraderBank8 bank(2, sampleRate);
+        std::vector<Buffer> bankOutputs(lanes, input);
+        for (int l = 0; l < lanes; ++l)
+            models[l].apply(&bank, l);
+
+        forEachBlock(frames, [&bank, &bankOutputs, frames](int offset, int size) {
+            float *channels[lanes][2];
+            float **buffers[lanes];
+            for (int l = 0; l < lanes; ++l) {
+                channels[l][0] = &bankOutputs[l][offset];
+                channels[l][1] = &bankOutputs[l][frames + offset];
+                buffers[l] = channels[l];
+            }
+            bank.process<float>(buffers, buffers, size);
+        });
+
+        for (int l = 0; l < lanes; ++l) {
+            RegraderProcess process(2, sampleRate);
+            models[l].apply(&process);
+
+            Buffer output = input;
+            forEachBlock(frames, [&process, &output, frames](int offset, int size) {
+                float *channels[2] = { &output[offset], &output[frames + offset] };
+                process.process<float>(channels, channels, 2, 2, size);
+            });
+
+            double maxError = 0;
+            bool finite = true;
+            for (size_t i = 0; i < output.size(); ++i) {
+                finite = finite && std::isfinite(bankOutputs[l][i]);
+                maxError = std::max(maxError, std::fabs((double)bankOutputs[l][i] - output[i]));
+            }
+
+            bool pass = finite && maxError <= tolerance;
+            if (!pass)
+                ++failures;
+
+            printf("%-4s lane %d %-10s max error %.3g (tolerance %g)\n",
+                   pass ? "ok" : "FAIL", l, signal.name, maxError, tolerance);
+        }
+    }
+
+    return failures == 0;
+}
+
+// -----------------------------------------------------------------------
+
+static void usage()
+{
+    fprintf(stderr,
+            "Usage: regrader-verify [options] write <reference-file>\n"
+            "       regrader-verify [options] compare <reference-file>\n"
+            "       regrader-verify list\n"
+            "       regrader-verify accuracy\n"
+            "       regrader-verify [options] bank\n"
+            "  -r <rate>      sample rate in Hz when writing or for bank (default 48000)\n"
+            "  -l <seconds>   length of the signals when writing or for bank (default 2)\n"
+            "  -f <text>      only render the cases whose name contains the text\n"
+            "  -m             skip the renders missing from the reference file when comparing,\n"
+            "                 e.g. of cases added after the reference was written\n"
+            "\n"
+            "The exit status of compare is 1 when any render exceeds its tolerance or is\n"
+            "missing from the reference file.\n"
+            "accuracy checks the error bounds of the approximations in Calc::Fast, its\n"
+            "exit status is 1 when any approximation exceeds its bound.\n"
+            "bank compares the lanes of a RegraderBank against a RegraderProcess with the\n"
+            "same settings, its exit status is 1 when any lane differs beyond rounding.\n");
+}
+
+int main(int argc, char *argv[])
+{
+    float sampleRate = 48000;
+    double seconds = 2;
+    const char *filter = nullptr;
+    bool skipMissing = false;
+
+    for (int c; (c = getopt(argc, argv, "r:l:f:mh")) != -1;) {
+        switch (c) {
+        case 'r': sampleRate = (float)atof(optarg); break;
+        case 'l': seconds = atof(optarg); break;
+        case 'f': filter = optarg; break;
+        case 'm': skipMissing = true; break;
+        default: usage(); return (c == 'h') ? 0 : 2;
+        }
+    }
+
+    int numArgs = argc - optind;
+    const char *command = (numArgs >= 1) ? argv[optind] : "";
+
+    if (!strcmp(command, "list") && numArgs == 1) {
+        for (const Case &testCase : cases) {
+            for (const Signal &signal : signals)
+                printf("%s/%s\n", testCase.name, signal.name);
+        }
+        return 0;
+    }
+
+    if (!strcmp(command, "accuracy") && numArgs == 1) {
+        unsigned failures = 0;
+        for (const Approximation &approximation : approximations) {
+            if (!checkAccuracy(approximation, 1 << 22))
+                ++failures;
+        }
+        return (failures > 0) ? 1 : 0;
+    }
+
+    if (!strcmp(command, "bank") && numArgs == 1 && sampleRate >= 1 && seconds > 0)
+        return checkBank(sampleRate, (int)(seconds * sampleRate), 1e-3) ? 0 : 1;
+
+    if (numArgs != 2 || sampleRate < 1 || seconds <= 0) {
+        usage();
+        return 2;
+    }
+
+    const char *path = argv[optind + 1];
+
+    if (!strcmp(command, "write")) {
+        int frames = (int)(seconds * sampleRate);
+        std::vector<Render> renders = renderAll(sampleRate, frames, filter);
+        if (!writeReference(path, sampleRate, frames, renders))
+            return 2;
+        printf("Wrote %zu renders of %d frames at %g Hz to %s\n", renders.size(), frames, sampleRate, path);
+        return 0;
+    }
+
+    if (!strcmp(command, "compare")) {
+        std::vector<Render> references;
+        int frames;
+        if (!readReference(path, sampleRate, frames, references))
+            return 2;
+
+        std::vector<Render> renders = renderAll(sampleRate, frames, filter);
+
+        unsigned failures = 0, missing = 0;
+        for (const Render &render : renders) {
+            auto it = std::find_if(references.begin(), references.end(),
+                                   [&render](const Render &r) { return r.name == render.name; });
+            if (it == references.end()) {
+                printf("%-4s %-28s not in the reference file\n", skipMissing ? "skip" : "FAIL", render.name.c_str());
+                ++missing;
+            }
+            else if (!compare(render, it->output))
+                ++failures;
+        }
+
+        printf("\n%zu renders, %u failed, %u not in the reference file\n", renders.size(), failures, missing);
+        return (failures > 0 || (missing > 0 && !skipMissing)) ? 1 : 0;
+    }
+
+    usage();
+    return 2;
+}
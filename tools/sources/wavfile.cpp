@@ -0,0 +1,339 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "wavfile.h"
+#include "sampleconvert.h"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error The sample conversions expect a little endian host
+#endif
+
+using namespace Igorski;
+
+enum {
+    kWaveFormatPcm = 1,
+    kWaveFormatFloat = 3,
+    kWaveFormatExtensible = 0xfffe,
+};
+
+// the chunks written ahead of the samples: the RIFF header, a JUNK chunk reserving
+// room for the ds64 chunk of RF64, the fmt chunk and the header of the data chunk
+static const size_t kHeaderSize = 12 + 36 + 24 + 8;
+
+int WavFormat::getSampleSize() const
+{
+    switch (sampleFormat) {
+    case kWavInt16: return 2;
+    case kWavInt24: return 3;
+    case kWavInt32: return 4;
+    case kWavFloat32: return 4;
+    case kWavFloat64: return 8;
+    }
+    return 0;
+}
+
+static uint64_t readLE(const uint8_t *data, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i)
+        value |= (uint64_t)data[i] << (8 * i);
+    return value;
+}
+
+static void writeLE(uint8_t *data, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        data[i] = (uint8_t)(value >> (8 * i));
+}
+
+// invoke the conversions with a constant amount of channels in the common
+// cases, which lets the compiler vectorize the (de)interleaving
+template <void (*Convert)(const uint8 *, int, float *const *, int)>
+static void deinterleave(const uint8_t *in, int channels, float *const *out, int frames)
+{
+    switch (channels) {
+    case 1: Convert(in, 1, out, frames); break;
+    case 2: Convert(in, 2, out, frames); break;
+    default: Convert(in, channels, out, frames); break;
+    }
+}
+
+template <void (*Convert)(const float *const *, int, uint8 *, int)>
+static void interleave(const float *const *in, int channels, uint8_t *out, int frames)
+{
+    switch (channels) {
+    case 1: Convert(in, 1, out, frames); break;
+    case 2: Convert(in, 2, out, frames); break;
+    default: Convert(in, channels, out, frames); break;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+WavReader::~WavReader()
+{
+    if (fMapping)
+        munmap(fMapping, fMappingSize);
+}
+
+bool WavReader::open(const char *path, std::string &error)
+{
+    int descriptor = ::open(path, O_RDONLY);
+    if (descriptor == -1) {
+        error = std::string("cannot open ") + path + ": " + strerror(errno);
+        return false;
+    }
+
+    struct stat status;
+    void *mapping = MAP_FAILED;
+    if (fstat(descriptor, &status) == 0 && status.st_size > 0)
+        mapping = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+
+    if (mapping == MAP_FAILED) {
+        error = std::string("cannot map ") + path;
+        return false;
+    }
+
+    fMapping = mapping;
+    fMappingSize = (size_t)status.st_size;
+    fDevice = (uint64_t)status.st_dev;
+    fInode = (uint64_t)status.st_ino;
+    madvise(fMapping, fMappingSize, MADV_SEQUENTIAL);
+
+    const uint8_t *data = (const uint8_t *)fMapping;
+    size_t size = fMappingSize;
+
+    bool isRF64 = size >= 12 && (!memcmp(data, "RF64", 4) || !memcmp(data, "BW64", 4));
+    if (size < 12 || (memcmp(data, "RIFF", 4) != 0 && !isRF64) || memcmp(data + 8, "WAVE", 4) != 0) {
+        error = std::string(path) + " is not a WAVE file";
+        return false;
+    }
+
+    const uint8_t *format = nullptr;
+    uint64_t dataSize64 = 0;
+
+    for (size_t offset = 12; offset + 8 <= size && !fSamples;) {
+        const uint8_t *chunk = data + offset;
+        uint64_t chunkSize = readLE(chunk + 4, 4);
+        size_t available = size - offset - 8;
+
+        if (!memcmp(chunk, "ds64", 4) && chunkSize >= 24 && chunkSize <= available)
+            dataSize64 = readLE(chunk + 16, 8);
+        else if (!memcmp(chunk, "fmt ", 4) && chunkSize >= 16 && chunkSize <= available)
+            format = chunk + 8;
+        else if (!memcmp(chunk, "data", 4)) {
+            // the size of RF64 data is found in the ds64 chunk, the size is also
+            // left unset by some writers which stream their output
+            if (isRF64 && chunkSize == 0xffffffff)
+                chunkSize = dataSize64;
+            fSamples = chunk + 8;
+            fFrames = (size_t)std::min<uint64_t>(chunkSize, available);
+        }
+
+        // chunks are aligned on 16 bits
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (!format || !fSamples) {
+        error = std::string(path) + " lacks a format or data chunk";
+        return false;
+    }
+
+    unsigned formatTag = (unsigned)readLE(format, 2);
+    if (formatTag == kWaveFormatExtensible && readLE(format + 16, 2) >= 22)
+        formatTag = (unsigned)readLE(format + 24, 2); // the sub format
+
+    fFormat.channels = (int)readLE(format + 2, 2);
+    fFormat.sampleRate = (unsigned)readLE(format + 4, 4);
+    unsigned bits = (unsigned)readLE(format + 14, 2);
+
+    bool supported = true;
+    if (formatTag == kWaveFormatPcm && bits == 16)
+        fFormat.sampleFormat = kWavInt16;
+    else if (formatTag == kWaveFormatPcm && bits == 24)
+        fFormat.sampleFormat = kWavInt24;
+    else if (formatTag == kWaveFormatPcm && bits == 32)
+        fFormat.sampleFormat = kWavInt32;
+    else if (formatTag == kWaveFormatFloat && bits == 32)
+        fFormat.sampleFormat = kWavFloat32;
+    else if (formatTag == kWaveFormatFloat && bits == 64)
+        fFormat.sampleFormat = kWavFloat64;
+    else
+        supported = false;
+
+    if (!supported || fFormat.channels < 1 || fFormat.channels > SampleConvert::MAX_INTERLEAVED_CHANNELS ||
+        fFormat.sampleRate < 1) {
+        error = std::string(path) + " has an unsupported sample format";
+        return false;
+    }
+
+    // the data size is in bytes until here, a trailing partial frame is ignored
+    fFrames /= fFormat.getFrameSize();
+    return true;
+}
+
+void WavReader::prefetch() const
+{
+    madvise(fMapping, fMappingSize, MADV_WILLNEED);
+}
+
+void WavReader::read(size_t offset, float *const *buffers, int frames) const
+{
+    const uint8_t *in = fSamples + offset * fFormat.getFrameSize();
+    int channels = fFormat.channels;
+
+    switch (fFormat.sampleFormat) {
+    case kWavInt16: deinterleave<SampleConvert::int16LEToFloat>(in, channels, buffers, frames); break;
+    case kWavInt24: deinterleave<SampleConvert::int24LEToFloat>(in, channels, buffers, frames); break;
+    case kWavInt32: deinterleave<SampleConvert::int32LEToFloat>(in, channels, buffers, frames); break;
+    case kWavFloat32: deinterleave<SampleConvert::float32LEToFloat>(in, channels, buffers, frames); break;
+    case kWavFloat64: deinterleave<SampleConvert::float64LEToFloat>(in, channels, buffers, frames); break;
+    }
+}
+
+bool WavReader::isSameFile(const char *path) const
+{
+    struct stat status;
+    return fMapping && stat(path, &status) == 0 && (uint64_t)status.st_dev == fDevice &&
+        (uint64_t)status.st_ino == fInode;
+}
+
+//------------------------------------------------------------------------------
+
+WavWriter::~WavWriter()
+{
+    if (fMapping)
+        munmap(fMapping, fMappingSize);
+
+    if (fDescriptor != -1) {
+        ::close(fDescriptor);
+        unlink(fPath.c_str());
+    }
+}
+
+bool WavWriter::create(const char *path, const WavFormat &format, size_t frames, std::string &error,
+                       const WavReader *input)
+{
+    if (input && input->isSameFile(path)) {
+        error = std::string("cannot create ") + path + ": it is the input file";
+        return false;
+    }
+
+    fPath = path;
+    fFormat = format;
+
+    uint64_t dataSize = (uint64_t)frames * format.getFrameSize();
+    uint64_t fileSize = kHeaderSize + dataSize + (dataSize & 1);
+    bool isRF64 = fileSize - 8 > 0xffffffff;
+
+    fDescriptor = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fDescriptor == -1) {
+        error = std::string("cannot create ") + path + ": " + strerror(errno);
+        return false;
+    }
+
+    // allocating the file up front reports a lack of space here, rather than
+    // by a signal upon writing into the mapping
+    int result = posix_fallocate(fDescriptor, 0, (off_t)fileSize);
+    if (result != 0) {
+        error = std::string("cannot allocate ") + path + ": " + strerror(result);
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, (size_t)fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+        error = std::string("cannot map ") + path;
+        return false;
+    }
+
+    fMapping = mapping;
+    fMappingSize = (size_t)fileSize;
+    madvise(fMapping, fMappingSize, MADV_SEQUENTIAL);
+
+    uint8_t *header = (uint8_t *)fMapping;
+    int frameSize = format.getFrameSize();
+    bool isFloat = format.sampleFormat == kWavFloat32 || format.sampleFormat == kWavFloat64;
+
+    memcpy(header, isRF64 ? "RF64" : "RIFF", 4);
+    writeLE(header + 4, isRF64 ? 0xffffffff : fileSize - 8, 4);
+    memcpy(header + 8, "WAVE", 4);
+
+    memcpy(header + 12, isRF64 ? "ds64" : "JUNK", 4);
+    writeLE(header + 16, 28, 4);
+    writeLE(header + 20, isRF64 ? fileSize - 8 : 0, 8);
+    writeLE(header + 28, isRF64 ? dataSize : 0, 8);
+    writeLE(header + 36, isRF64 ? frames : 0, 8);
+    writeLE(header + 44, 0, 4); // no table entries
+
+    memcpy(header + 48, "fmt ", 4);
+    writeLE(header + 52, 16, 4);
+    writeLE(header + 56, isFloat ? kWaveFormatFloat : kWaveFormatPcm, 2);
+    writeLE(header + 58, format.channels, 2);
+    writeLE(header + 60, format.sampleRate, 4);
+    writeLE(header + 64, (uint64_t)format.sampleRate * frameSize, 4);
+    writeLE(header + 68, frameSize, 2);
+    writeLE(header + 70, format.getSampleSize() * 8, 2);
+
+    memcpy(header + 72, "data", 4);
+    writeLE(header + 76, isRF64 ? 0xffffffff : dataSize, 4);
+
+    fSamples = header + kHeaderSize;
+    return true;
+}
+
+void WavWriter::write(size_t offset, const float *const *buffers, int frames)
+{
+    uint8_t *out = fSamples + offset * fFormat.getFrameSize();
+    int channels = fFormat.channels;
+
+    switch (fFormat.sampleFormat) {
+    case kWavInt16: interleave<SampleConvert::floatToInt16LE>(buffers, channels, out, frames); break;
+    case kWavInt24: interleave<SampleConvert::floatToInt24LE>(buffers, channels, out, frames); break;
+    case kWavInt32: interleave<SampleConvert::floatToInt32LE>(buffers, channels, out, frames); break;
+    case kWavFloat32: interleave<SampleConvert::floatToFloat32LE>(buffers, channels, out, frames); break;
+    case kWavFloat64: interleave<SampleConvert::floatToFloat64LE>(buffers, channels, out, frames); break;
+    }
+}
+
+bool WavWriter::close(std::string &error)
+{
+    bool success = munmap(fMapping, fMappingSize) == 0;
+    fMapping = nullptr;
+
+    success = ::close(fDescriptor) == 0 && success;
+    fDescriptor = -1;
+
+    if (!success) {
+        error = std::string("cannot write ") + fPath;
+        unlink(fPath.c_str());
+    }
+    return success;
+}
@@ -0,0 +1,105 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 The Regrader port authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+enum WavSampleFormat { kWavInt16, kWavInt24, kWavInt32, kWavFloat32, kWavFloat64 };
+
+struct WavFormat
+{
+    int channels = 0;
+    unsigned sampleRate = 0;
+    WavSampleFormat sampleFormat = kWavFloat32;
+
+    int getSampleSize() const;
+    int getFrameSize() const { return channels * getSampleSize(); }
+};
+
+// a WAVE or RF64 file mapped into memory for reading, of 16, 24 or 32-bit
+// integer or 32 or 64-bit float samples in up to 8 channels
+class WavReader
+{
+public:
+    WavReader() = default;
+    ~WavReader();
+
+    WavReader(const WavReader &) = delete;
+    WavReader &operator=(const WavReader &) = delete;
+
+    bool open(const char *path, std::string &error);
+
+    const WavFormat &getFormat() const { return fFormat; }
+    size_t getFrames() const { return fFrames; }
+
+    // asks the system to read the samples ahead in the background
+    void prefetch() const;
+
+    // converts given frames starting at offset into planar buffers, one per channel
+    void read(size_t offset, float *const *buffers, int frames) const;
+
+    // whether the file at given path is the file this reader has mapped
+    bool isSameFile(const char *path) const;
+
+private:
+    void *fMapping = nullptr;
+    size_t fMappingSize = 0;
+    const uint8_t *fSamples = nullptr;
+    size_t fFrames = 0;
+    WavFormat fFormat;
+    uint64_t fDevice = 0;
+    uint64_t fInode = 0;
+};
+
+// a WAVE file mapped into memory for writing, which becomes a RF64 file when
+// its size exceeds the 4 GiB a WAVE file can describe
+class WavWriter
+{
+public:
+    WavWriter() = default;
+    ~WavWriter();
+
+    WavWriter(const WavWriter &) = delete;
+    WavWriter &operator=(const WavWriter &) = delete;
+
+    // creates the file with room for given amount of frames. Truncating the file of
+    // the input would destroy the samples it still maps, so the input is refused
+    bool create(const char *path, const WavFormat &format, size_t frames, std::string &error,
+                const WavReader *input = nullptr);
+
+    // converts given frames from planar buffers, one per channel, into the file at offset
+    void write(size_t offset, const float *const *buffers, int frames);
+
+    // completes the file, an incomplete file is removed upon destruction
+    bool close(std::string &error);
+
+private:
+    std::string fPath;
+    int fDescriptor = -1;
+    void *fMapping = nullptr;
+    size_t fMappingSize = 0;
+    uint8_t *fSamples = nullptr;
+    WavFormat fFormat;
+};